@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Benchmarks of the engine, run with -csv or -o results.xml,xml
+#
+#-------------------------------------------------
+
+QT       += core network testlib
+
+QT       -= gui
+
+TARGET = roabenchmark
+TEMPLATE = app
+
+CONFIG += console
+
+# The verification and download engine
+include(roaengine.pri)
+
+SOURCES +=      src/cpp/roabenchmark.cpp
+
+HEADERS  +=     src/h/roabenchmark.h
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Links the engine library, include it in projects using the engine
+# Set ROAENGINE_BUILD_DIR if the library is not built next to the project
+#
+#-------------------------------------------------
+
+QT += network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+INCLUDEPATH += $$PWD/src/h
+
+isEmpty(ROAENGINE_BUILD_DIR): ROAENGINE_BUILD_DIR = $$OUT_PWD
+
+# Visual Studio builds put the library into the debug or release directory
+win32:CONFIG(debug, debug|release): ROAENGINE_LIB_DIR = $$ROAENGINE_BUILD_DIR/debug
+else:win32: ROAENGINE_LIB_DIR = $$ROAENGINE_BUILD_DIR/release
+else: ROAENGINE_LIB_DIR = $$ROAENGINE_BUILD_DIR
+
+# zstd and zlib for binary patches and compressed downloads
+LIBS += -L$$ROAENGINE_LIB_DIR -lroaengine -lzstd -lz
+
+# Relink when the library changed
+win32-msvc*: PRE_TARGETDEPS += $$ROAENGINE_LIB_DIR/roaengine.lib
+else: PRE_TARGETDEPS += $$ROAENGINE_LIB_DIR/libroaengine.a
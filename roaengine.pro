@@ -0,0 +1,43 @@
+#-------------------------------------------------
+#
+# Verification and download engine of the installer
+#
+#-------------------------------------------------
+
+QT       += core network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+# No widgets, the engine is used by the installer, the headless mode and the launcher
+QT       -= gui
+
+TARGET = roaengine
+TEMPLATE = lib
+CONFIG += staticlib
+
+SOURCES +=      src/cpp/roaengine.cpp \
+                src/cpp/roahashcache.cpp \
+                src/cpp/roadecompressor.cpp \
+                src/cpp/roachunkstore.cpp \
+                src/cpp/roatarextractor.cpp \
+                src/cpp/roaprogress.cpp \
+                src/cpp/roaeventwriter.cpp \
+                src/cpp/roametrics.cpp \
+                src/cpp/roatrace.cpp \
+                src/cpp/roafilelistparser.cpp \
+                src/cpp/roaenginethread.cpp
+
+# The certificates of the download server, a static library has to initialize them itself
+RESOURCES +=    resources/roaengine.qrc
+
+HEADERS  +=     src/h/roaengine.h \
+                src/h/roahashcache.h \
+                src/h/roadecompressor.h \
+                src/h/roachunkstore.h \
+                src/h/roatarextractor.h \
+                src/h/roaprogress.h \
+                src/h/roaeventwriter.h \
+                src/h/roametrics.h \
+                src/h/roatrace.h \
+                src/h/roafilelistparser.h \
+                src/h/roaenginethread.h
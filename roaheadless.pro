@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# The installer without widgets, same as roainstaller --headless for hosts without QtWidgets
+#
+#-------------------------------------------------
+
+QT       += core network
+
+QT       -= gui
+
+TARGET = roaheadless
+TEMPLATE = app
+
+CONFIG += console
+
+# The verification and download engine
+include(roaengine.pri)
+
+SOURCES +=      src/cpp/roaheadlessmain.cpp \
+                src/cpp/roaconsole.cpp
+
+HEADERS  +=     src/h/roaconsole.h
@@ -1,59 +1,22 @@
 #-------------------------------------------------
 #
-# Project created by QtCreator 2012-11-21T09:57:59
+# The engine library, the installers using it, the benchmarks and the test server
 #
 #-------------------------------------------------
 
-QT       += core gui network
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+SUBDIRS = engine installer headless benchmark mockcdn
 
-TARGET = roainstaller
-TEMPLATE = app
+engine.file = roaengine.pro
 
-# Special libs for windows build - since qt5 qmake can not work this that, should be fixed
-#win32
-#{
-#    win32-msvc*:contains(QMAKE_TARGET.arch, x86_64):
-#    {
-#       LIBS += "C:/buildenv/w8sdk/Lib/win8/um/x64/Shell32.lib"
-#    }
-#    else
-#    {
-#    }
-#}
+installer.file = roainstallerapp.pro
+installer.depends = engine
 
-SOURCES +=      src/cpp/main.cpp\
-                src/cpp/roapagewelcome.cpp \
-                src/cpp/roapagelicense.cpp \
-                src/cpp/roapagecomponents.cpp \
-                src/cpp/roapageinstall.cpp \
-                src/cpp/roapagestatus.cpp \
-                src/cpp/roapagefinish.cpp \
-                src/cpp/roainstaller.cpp
+headless.file = roaheadless.pro
+headless.depends = engine
 
-HEADERS  +=     src/h/roapagewelcome.h \
-                src/h/roapagelicense.h \
-                src/h/roapagecomponents.h \
-                src/h/roapageinstall.h \
-                src/h/roapagestatus.h \
-                src/h/roapagefinish.h \
-                src/h/roainstaller.h
-
-FORMS    +=     src/ui/roapagewelcome.ui \
-                src/ui/roapagelicense.ui \
-                src/ui/roapagecomponents.ui \
-                src/ui/roapageinstall.ui \
-                src/ui/roapagestatus.ui \
-                src/ui/roapagefinish.ui
-
-TRANSLATIONS =  resources/translation/roai_eng.ts \
-                resources/translation/roai_ger.ts \
-                resources/translation/roai_fra.ts \
-                resources/translation/roai_spa.ts \
-                resources/translation/roai_ita.ts
-
-RESOURCES +=    resources/res.qrc
-
-OTHER_FILES +=
+benchmark.file = roabenchmark.pro
+benchmark.depends = engine
 
+mockcdn.file = roamockcdn.pro
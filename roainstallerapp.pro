@@ -0,0 +1,64 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2012-11-21T09:57:59
+#
+#-------------------------------------------------
+
+QT       += core gui network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+TARGET = roainstaller
+TEMPLATE = app
+
+# The verification and download engine
+include(roaengine.pri)
+
+# Special libs for windows build - since qt5 qmake can not work this that, should be fixed
+#win32
+#{
+#    win32-msvc*:contains(QMAKE_TARGET.arch, x86_64):
+#    {
+#       LIBS += "C:/buildenv/w8sdk/Lib/win8/um/x64/Shell32.lib"
+#    }
+#    else
+#    {
+#    }
+#}
+
+SOURCES +=      src/cpp/main.cpp\
+                src/cpp/roapagewelcome.cpp \
+                src/cpp/roapagelicense.cpp \
+                src/cpp/roapagecomponents.cpp \
+                src/cpp/roapageinstall.cpp \
+                src/cpp/roapagestatus.cpp \
+                src/cpp/roapagefinish.cpp \
+                src/cpp/roainstaller.cpp \
+                src/cpp/roaconsole.cpp
+
+HEADERS  +=     src/h/roapagewelcome.h \
+                src/h/roapagelicense.h \
+                src/h/roapagecomponents.h \
+                src/h/roapageinstall.h \
+                src/h/roapagestatus.h \
+                src/h/roapagefinish.h \
+                src/h/roainstaller.h \
+                src/h/roaconsole.h
+
+FORMS    +=     src/ui/roapagewelcome.ui \
+                src/ui/roapagelicense.ui \
+                src/ui/roapagecomponents.ui \
+                src/ui/roapageinstall.ui \
+                src/ui/roapagestatus.ui \
+                src/ui/roapagefinish.ui
+
+TRANSLATIONS =  resources/translation/roai_eng.ts \
+                resources/translation/roai_ger.ts \
+                resources/translation/roai_fra.ts \
+                resources/translation/roai_spa.ts \
+                resources/translation/roai_ita.ts
+
+RESOURCES +=    resources/res.qrc
+
+OTHER_FILES +=
+
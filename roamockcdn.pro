@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Local test server with a synthetic release, see roamockcdn --help
+#
+#-------------------------------------------------
+
+QT       += core network
+
+QT       -= gui
+
+TARGET = roamockcdn
+TEMPLATE = app
+
+CONFIG += console
+
+SOURCES +=      src/cpp/roamockcdnmain.cpp \
+                src/cpp/roamockcdn.cpp
+
+HEADERS  +=     src/h/roamockcdn.h
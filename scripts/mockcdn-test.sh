@@ -0,0 +1,87 @@
+#!/bin/sh
+#
+# Install a synthetic release from roamockcdn with roaheadless and verify it.
+#
+# Usage: scripts/mockcdn-test.sh [directory with roamockcdn and roaheadless]
+#
+# Settings of the server can be changed with the environment:
+#   FILES, SIZE, BANDWIDTH, LATENCY, DROP, ERROR and SEED, see roamockcdn --help.
+#
+# Exit code 0 if installing and verifying succeeded.
+
+BIN=${1:-.}
+FILES=${FILES:-100}
+SIZE=${SIZE:-1048576}
+BANDWIDTH=${BANDWIDTH:-0}
+LATENCY=${LATENCY:-20}
+DROP=${DROP:-5}
+ERROR=${ERROR:-5}
+SEED=${SEED:-1}
+
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/roamockcdn.XXXXXX") || exit 1
+SERVER=
+
+cleanup()
+{
+    if [ -n "$SERVER" ]
+    then
+        kill "$SERVER" 2>/dev/null
+        wait "$SERVER" 2>/dev/null
+    fi
+
+    rm -rf "$WORK"
+}
+
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+# Port 0 takes any free port, the server prints the one it got
+"$BIN/roamockcdn" --port 0 --files "$FILES" --size "$SIZE" --bandwidth "$BANDWIDTH" \
+    --latency "$LATENCY" --drop "$DROP" --error "$ERROR" --seed "$SEED" > "$WORK/server.log" 2>&1 &
+SERVER=$!
+
+URL=
+for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20
+do
+    URL=$(sed -n 's/.*--base-url \(http[^ ]*\).*/\1/p' "$WORK/server.log")
+
+    if [ -n "$URL" ] || ! kill -0 "$SERVER" 2>/dev/null
+    then
+        break
+    fi
+
+    sleep 0.5
+done
+
+if [ -z "$URL" ]
+then
+    echo "roamockcdn did not start:" >&2
+    cat "$WORK/server.log" >&2
+    exit 1
+fi
+
+echo "Installing from $URL"
+
+"$BIN/roaheadless" --path "$WORK/roa" --base-url "$URL" --metrics "$WORK/install.prom" install
+CODE=$?
+
+if [ "$CODE" -ne 0 ]
+then
+    echo "Installing failed with exit code $CODE" >&2
+    exit 1
+fi
+
+# Hashes every file again, damaged ones are downloaded once more and fail without a working server
+"$BIN/roaheadless" --path "$WORK/roa" --base-url "$URL" --deep verify
+CODE=$?
+
+if [ "$CODE" -ne 0 ]
+then
+    echo "Verifying failed with exit code $CODE" >&2
+    exit 1
+fi
+
+cat "$WORK/install.prom"
+
+echo "Installing and verifying succeeded"
+exit 0
@@ -41,6 +41,7 @@
 /******************************************************************************/
 //#include <QtPlugin>
 #include <QApplication>
+#include <QScopedPointer>
 #include <QFontDatabase>
 #include <QMessageBox>
 
@@ -50,6 +51,8 @@
 /*                                                                            */
 /******************************************************************************/
 #include "../h/roainstaller.h"
+#include "../h/roaconsole.h"
+#include "../h/roaeventwriter.h"
 
 /**
  * \brief The main loop-
@@ -66,6 +69,15 @@ int main(int argc, char *argv[])
 {
     //Q_IMPORT_PLUGIN(QXcbIntegrationPlugin);
 
+    // Decide before creating the application, QApplication needs a display
+    for(int i = 1; i < argc; i++)
+    {
+        if(QString(argv[i]) == "--headless")
+        {
+            return ROAConsole::runHeadless(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
     
     // Set appliaction properties
@@ -80,6 +92,9 @@ int main(int argc, char *argv[])
     // Add custom font
     QFontDatabase::addApplicationFont(":/font/ModernAntiqua.ttf");
 
+    // The listener is called on the engine thread, it has to outlive the installer
+    QScopedPointer<ROAEventWriter> events;
+
     // Start the installer
     ROAInstaller installer;
 
@@ -91,6 +106,15 @@ int main(int argc, char *argv[])
      * Arg: repair: Repair all client files, remove game content
      * Arg: uninstall: Remove client and game content
      *
+     * Option: --deep: Ignore the hash cache and hash all files
+     * Option: --headless: No widgets, report to the console (install, update, verify, repair, uninstall)
+     * Option: --yes: Confirm uninstalling in headless mode
+     * Option: --path <dir>: Installation directory for headless mode
+     * Option: --events <file>: Write the events as JSON lines to a file, named pipe or - for stdout
+     * Option: --metrics <file>: Write the phase metrics for the Prometheus textfile collector
+     * Option: --trace <file>: Write a Chrome trace of the run for about:tracing or Perfetto
+     * Option: --base-url <url>: Download from another server, e.g. roamockcdn
+     *
      */
 
     QString text(QObject::tr("Valid arguments:\n"
@@ -100,17 +124,90 @@ int main(int argc, char *argv[])
                     "   repair - Try to repair a broken installation\n"
                     "   uninstall - Remove client and game content- WARNING IF THE DIRECOTRY CONTAINS OTHER FILES THEN FROM ROA, THESE ARE ALSO DELETE!\n"
                     "   \n"
+                    "Options:\n"
+                    "   --deep - Hash all files, do not trust the hash cache\n"
+                    "   --headless - No window, report to the console, exit code 0 on success, 1 on failed files, 2 on errors\n"
+                    "                Uninstalling needs --yes, install is the default action\n"
+                    "   --yes - Confirm uninstalling in headless mode, nobody is asked\n"
+                    "   --path <dir> - Installation directory for headless mode\n"
+                    "   --events <file> - Write phases, files, progress and a summary as JSON lines\n"
+                    "                     to a file or named pipe, - for stdout\n"
+                    "   --metrics <file> - Write time, bytes and throughput of each phase for the\n"
+                    "                      Prometheus textfile collector, the file should end with .prom\n"
+                    "   --trace <file> - Write verify, request, write and commit spans as a Chrome trace\n"
+                    "                    for about:tracing or Perfetto\n"
+                    "   --base-url <url> - Data directory of another server, e.g. a mirror or roamockcdn\n"
+                    "   \n"
                     "Sample: roainstaller update"));
 
-    if(argc == 1)
+    QStringList arguments = a.arguments();
+
+    // Remove the binary
+    arguments.removeFirst();
+
+    // Options are valid for all actions
+    if(arguments.removeAll("--deep") > 0)
+    {
+        installer.setDeepVerify(true);
+    }
+
+    QString eventTarget;
+
+    if(!ROAConsole::takeOption(arguments, "--events", eventTarget))
+    {
+        QMessageBox::information(NULL,QObject::tr("Invalid argument"), QObject::tr("--events needs a file or -\n\n") + text);
+        return 2;
+    }
+
+    if(!eventTarget.isEmpty())
+    {
+        events.reset(ROAConsole::openEvents(eventTarget));
+
+        if(!events.isNull())
+        {
+            installer.addListener(events.data());
+        }
+    }
+
+    QString metricsFile;
+
+    if(!ROAConsole::takeOption(arguments, "--metrics", metricsFile))
+    {
+        QMessageBox::information(NULL,QObject::tr("Invalid argument"), QObject::tr("--metrics needs a file\n\n") + text);
+        return 2;
+    }
+
+    installer.setMetricsFile(metricsFile);
+
+    QString traceFile;
+
+    if(!ROAConsole::takeOption(arguments, "--trace", traceFile))
+    {
+        QMessageBox::information(NULL,QObject::tr("Invalid argument"), QObject::tr("--trace needs a file\n\n") + text);
+        return 2;
+    }
+
+    installer.setTraceFile(traceFile);
+
+    QString baseUrl;
+
+    if(!ROAConsole::takeOption(arguments, "--base-url", baseUrl))
+    {
+        QMessageBox::information(NULL,QObject::tr("Invalid argument"), QObject::tr("--base-url needs an url\n\n") + text);
+        return 2;
+    }
+
+    installer.setBaseUrl(baseUrl);
+
+    if(arguments.size() == 0)
     {
         installer.install();
 
         return a.exec();
     }
-    else if(argc == 2)
+    else if(arguments.size() == 1)
     {
-        QString action = argv[1];
+        QString action = arguments.at(0);
 
         /// \todo Keep the /slient for compatiblity
         if(action == "update" || action == "/silent")
@@ -131,7 +228,7 @@ int main(int argc, char *argv[])
         else if(action == "uninstall")
         {
             installer.uninstall();
-            a.quit();
+            return a.exec();
         }
         else
         {
@@ -0,0 +1,302 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Benchmarks of the engine
+ *
+ * \file    	roabenchmark.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QFile>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roabenchmark.h"
+#include "../h/roaengine.h"
+#include "../h/roafilelistparser.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+QString ROABenchmark::writeFile(QString _fileName, qint64 _size)
+{
+    QFile file(_fileName);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    // Random data, file systems with compression must not shrink it
+    QByteArray block(1024 * 1024, 0);
+    quint32 state = 2166136261u;
+
+    for(int i = 0; i < block.size(); i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        block[i] = (char)(state >> 24);
+    }
+
+    qint64 left = _size;
+
+    while(left > 0)
+    {
+        qint64 size = qMin(left, (qint64)block.size());
+
+        file.write(block.constData(), size);
+        hash.addData(block.constData(), size);
+
+        left -= size;
+    }
+
+    file.close();
+
+    return QString(hash.result().toHex());
+}
+
+void ROABenchmark::writeFileList(QString _fileName, int _entries)
+{
+    QFile file(_fileName);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return;
+    }
+
+    QTextStream out(&file);
+
+    // A bundle every 1000 files, a patch and compression for every tenth, like a real release
+    for(int i = 0; i < _entries; i++)
+    {
+        if(i % 1000 == 0)
+        {
+            out << "bundle;game/data/" << i / 1000 << "\n";
+        }
+
+        QByteArray hash = QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Sha256).toHex();
+
+        out << "game/data/" << i / 1000 << "/file" << i << ".pak;" << hash << ";" << ((qint64)i * 7919) % 100000000;
+
+        if(i % 10 == 0)
+        {
+            out << ";" << hash.left(32) << "," << hash.right(32) << ";zst";
+        }
+
+        out << "\n";
+    }
+
+    out.flush();
+    file.close();
+}
+
+void ROABenchmark::createTree(QString _dir, int _depth, int _width, int _files)
+{
+    QDir().mkpath(_dir);
+
+    for(int i = 0; i < _files; i++)
+    {
+        QFile file(_dir + "/file" + QString::number(i));
+        file.open(QIODevice::WriteOnly);
+        file.write("data");
+        file.close();
+    }
+
+    if(_depth <= 0)
+    {
+        return;
+    }
+
+    for(int i = 0; i < _width; i++)
+    {
+        createTree(_dir + "/dir" + QString::number(i), _depth - 1, _width, _files);
+    }
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Slots                                                                   */
+/*                                                                            */
+/******************************************************************************/
+
+void ROABenchmark::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+}
+
+void ROABenchmark::checkFileWithHash_data()
+{
+    QTest::addColumn<qint64>("size");
+
+    QTest::newRow("4 KB") << (qint64)4 * 1024;
+    QTest::newRow("1 MB") << (qint64)1024 * 1024;
+    QTest::newRow("256 MB") << (qint64)256 * 1024 * 1024;
+}
+
+void ROABenchmark::checkFileWithHash()
+{
+    QFETCH(qint64, size);
+
+    QString fileName = tempDir.path() + "/hash" + QString::number(size);
+    QString hash = writeFile(fileName, size);
+
+    QVERIFY(!hash.isEmpty());
+
+    // The file is in the page cache, this measures the hashing and not the disk
+    QBENCHMARK
+    {
+        QVERIFY(ROAEngine::checkFileWithHash(fileName, hash));
+    }
+
+    QFile::remove(fileName);
+}
+
+void ROABenchmark::parseFileList_data()
+{
+    QTest::addColumn<int>("entries");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+void ROABenchmark::parseFileList()
+{
+    QFETCH(int, entries);
+
+    QString fileName = tempDir.path() + "/files" + QString::number(entries) + ".txt";
+    writeFileList(fileName, entries);
+
+    QList<ROAVerifyJob> jobs;
+    QStringList bundles;
+
+    QBENCHMARK
+    {
+        jobs.clear();
+        bundles.clear();
+
+        QVERIFY(ROAEngine::parseFileList(fileName, &jobs, &bundles));
+    }
+
+    QCOMPARE(jobs.size(), entries);
+
+    QFile::remove(fileName);
+}
+
+void ROABenchmark::fileListParser_data()
+{
+    parseFileList_data();
+}
+
+void ROABenchmark::fileListParser()
+{
+    QFETCH(int, entries);
+
+    QString fileName = tempDir.path() + "/files" + QString::number(entries) + ".txt";
+    writeFileList(fileName, entries);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QByteArray content = file.readAll();
+
+    file.close();
+    QFile::remove(fileName);
+
+    QElapsedTimer timer;
+    qint64 parsed = 0;
+
+    timer.start();
+
+    // Repeat for at least a second, small lists are done in microseconds
+    do
+    {
+        ROAFileListParser parser(content.constData(), content.size());
+        ROAFileListEntry entry;
+
+        while(parser.next(&entry))
+        {
+            parsed += entry.bundle ? 0 : 1;
+        }
+    }
+    while(timer.elapsed() < 1000);
+
+    QVERIFY(parsed % entries == 0);
+
+    QTest::setBenchmarkResult(parsed / (timer.nsecsElapsed() / 1000000000.0), QTest::Events);
+}
+
+void ROABenchmark::removeDirWithContent_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("files");
+
+    QTest::newRow("deep") << 64 << 1 << 4;
+    QTest::newRow("wide") << 4 << 8 << 4;
+    QTest::newRow("many files") << 1 << 10 << 1000;
+}
+
+void ROABenchmark::removeDirWithContent()
+{
+    QFETCH(int, depth);
+    QFETCH(int, width);
+    QFETCH(int, files);
+
+    QString dir = tempDir.path() + "/tree";
+
+    createTree(dir, depth, width, files);
+
+    // The tree is gone after the first run, it can only be measured once
+    QBENCHMARK_ONCE
+    {
+        QVERIFY(ROAEngine::removeDirWithContent(dir));
+    }
+
+    QVERIFY(!QDir(dir).exists());
+}
+
+QTEST_GUILESS_MAIN(ROABenchmark)
@@ -0,0 +1,249 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Content defined chunks of installed files for reuse in new releases
+ *
+ * \file    	roachunkstore.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roachunkstore.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAChunkStore::ROAChunkStore()
+{
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+bool ROAChunkStore::load(QString _installationPath)
+{
+    installationPath = _installationPath;
+    chunks.clear();
+    files.clear();
+
+    QFile file(installationPath + "launcher/downloads/chunks.txt");
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QTextStream in(&file);
+
+    // Format: hash;size;file;offset
+    while(!in.atEnd())
+    {
+        QStringList tmp = in.readLine().split(";");
+
+        if(tmp.size() == 4)
+        {
+            ROAChunkLocation location;
+            location.size = tmp.at(1).toLongLong();
+            location.file = tmp.at(2);
+            location.offset = tmp.at(3).toLongLong();
+
+            chunks.insert(tmp.at(0), location);
+            files[location.file].insert(tmp.at(0));
+        }
+    }
+
+    file.close();
+
+    return true;
+}
+
+bool ROAChunkStore::save()
+{
+    if(installationPath.isEmpty())
+    {
+        return false;
+    }
+
+    QFile file(installationPath + "launcher/downloads/chunks.txt.part");
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    QMultiHash<QString, ROAChunkLocation>::const_iterator i;
+
+    for(i = chunks.constBegin(); i != chunks.constEnd(); ++i)
+    {
+        out << i.key() << ";" << i.value().size << ";" << i.value().file << ";" << i.value().offset << "\n";
+    }
+
+    out.flush();
+    file.close();
+
+    QFile::remove(installationPath + "launcher/downloads/chunks.txt");
+
+    return QFile::rename(installationPath + "launcher/downloads/chunks.txt.part", installationPath + "launcher/downloads/chunks.txt");
+}
+
+bool ROAChunkStore::readIndex(QString _file, QList<ROAChunk> *_chunks)
+{
+    QFile file(_file);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    return parseIndex(file.readAll(), _chunks);
+}
+
+bool ROAChunkStore::parseIndex(const QByteArray &_data, QList<ROAChunk> *_chunks)
+{
+    QTextStream in(_data);
+
+    while(!in.atEnd())
+    {
+        QStringList tmp = in.readLine().split(";");
+
+        if(tmp.size() != 2 || tmp.at(0).size() != 64)
+        {
+            return false;
+        }
+
+        ROAChunk chunk;
+        chunk.hash = tmp.at(0);
+        chunk.size = tmp.at(1).toLongLong();
+
+        if(chunk.size <= 0)
+        {
+            return false;
+        }
+
+        _chunks->append(chunk);
+    }
+
+    return true;
+}
+
+bool ROAChunkStore::readChunk(const ROAChunk &_chunk, QByteArray *_data)
+{
+    QList<ROAChunkLocation> locations = chunks.values(_chunk.hash);
+
+    for(int i = 0; i < locations.size(); i++)
+    {
+        const ROAChunkLocation &location = locations.at(i);
+
+        if(location.size != _chunk.size)
+        {
+            continue;
+        }
+
+        QFile file(installationPath + location.file);
+
+        if(!file.open(QIODevice::ReadOnly) || !file.seek(location.offset))
+        {
+            continue;
+        }
+
+        *_data = file.read(location.size);
+
+        // The file may have changed since
+        if(_data->size() == location.size && QString(QCryptographicHash::hash(*_data, QCryptographicHash::Sha256).toHex()) == _chunk.hash)
+        {
+            return true;
+        }
+    }
+
+    _data->clear();
+
+    return false;
+}
+
+void ROAChunkStore::addFile(QString _file, const QList<ROAChunk> &_chunks)
+{
+    // Forget the chunks of the old release of this file
+    removeFile(_file);
+
+    QSet<QString> &hashes = files[_file];
+
+    qint64 offset = 0;
+
+    for(int j = 0; j < _chunks.size(); j++)
+    {
+        ROAChunkLocation location;
+        location.file = _file;
+        location.offset = offset;
+        location.size = _chunks.at(j).size;
+
+        chunks.insert(_chunks.at(j).hash, location);
+        hashes.insert(_chunks.at(j).hash);
+
+        offset += location.size;
+    }
+}
+
+void ROAChunkStore::removeFile(QString _file)
+{
+    // Only the places of the chunks of this file are visited
+    foreach(QString hash, files.take(_file))
+    {
+        QMultiHash<QString, ROAChunkLocation>::iterator i = chunks.find(hash);
+
+        while(i != chunks.end() && i.key() == hash)
+        {
+            if(i.value().file == _file)
+            {
+                i = chunks.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+}
+
+bool ROAChunkStore::contains(QString _file) const
+{
+    return files.contains(_file);
+}
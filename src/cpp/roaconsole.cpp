@@ -0,0 +1,399 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Headless installer, reports to the console instead of widgets
+ *
+ * \file    	roaconsole.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roaconsole.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAConsole::ROAConsole(QObject *parent) :
+    QObject(parent)
+{
+    deepVerify = false;
+    logToStderr = false;
+    lastPercent = -1;
+    exitCode = 0;
+
+    // Same settings as the graphical installer and the launcher
+    userSettings = new QSettings(QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), "Relics of Annorath Launcher");
+
+    installationPath = userSettings->value("installLocation", "none").toString();
+
+    if(installationPath == "none")
+    {
+        installationPath.clear();
+    }
+    else if(!installationPath.endsWith("/"))
+    {
+        installationPath += "/";
+    }
+
+    // The engine runs on its own thread, all communication is queued
+    engine = engineThread.getEngine();
+    engineThread.startFor(this);
+}
+
+ROAConsole::~ROAConsole()
+{
+    delete userSettings;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAConsole::setInstallationPath(QString _path)
+{
+    installationPath = QDir::fromNativeSeparators(QDir(_path).absolutePath());
+
+    if(!installationPath.endsWith("/"))
+    {
+        installationPath += "/";
+    }
+
+    userSettings->setValue("installLocation", installationPath);
+}
+
+void ROAConsole::setDeepVerify(bool _deep)
+{
+    deepVerify = _deep;
+}
+
+void ROAConsole::setLogToStderr(bool _stderr)
+{
+    logToStderr = _stderr;
+}
+
+void ROAConsole::addListener(ROAEngineListener *_listener)
+{
+    engine->addListener(_listener);
+}
+
+void ROAConsole::setMetricsFile(QString _fileName)
+{
+    engine->setMetricsFile(_fileName);
+}
+
+void ROAConsole::setTraceFile(QString _fileName)
+{
+    engine->setTraceFile(_fileName);
+}
+
+void ROAConsole::setBaseUrl(QString _url)
+{
+    engine->setBaseUrl(_url);
+}
+
+void ROAConsole::run(QString _mode)
+{
+    if(installationPath.isEmpty())
+    {
+        fail(tr("No installation found, use --path to set the installation directory"), 2);
+        return;
+    }
+
+    if(_mode == "uninstall")
+    {
+        printLine(tr("Removing ") + installationPath);
+        emit startUninstall(installationPath);
+    }
+    else
+    {
+        printLine(tr("Checking ") + installationPath);
+        emit startEngine(installationPath, _mode, deepVerify);
+    }
+}
+
+bool ROAConsole::takeOption(QStringList &_arguments, QString _option, QString &_value)
+{
+    int index = _arguments.indexOf(_option);
+
+    if(index < 0)
+    {
+        return true;
+    }
+
+    if(index + 1 >= _arguments.size())
+    {
+        return false;
+    }
+
+    _value = _arguments.at(index + 1);
+
+    _arguments.removeAt(index + 1);
+    _arguments.removeAt(index);
+
+    return true;
+}
+
+ROAEventWriter *ROAConsole::openEvents(QString _target)
+{
+    ROAEventWriter *events = new ROAEventWriter(_target);
+
+    if(!events->isOpen())
+    {
+        QTextStream(stderr) << QObject::tr("Could not open the event stream ") << _target << "\n";
+
+        delete events;
+        return NULL;
+    }
+
+    return events;
+}
+
+int ROAConsole::runHeadless(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // Same names as the graphical installer, the settings are shared
+    a.setApplicationName("Relics of Annorath Installer");
+    a.setApplicationVersion("001.000.000");
+
+    a.setOrganizationName("QuantumBytes inc.");
+    a.setOrganizationDomain("quantum-bytes.com");
+
+    QStringList arguments = a.arguments();
+
+    // Remove the binary and the mode switch
+    arguments.removeFirst();
+    arguments.removeAll("--headless");
+
+    bool deep = arguments.removeAll("--deep") > 0;
+    bool confirmed = arguments.removeAll("--yes") > 0;
+
+    QString path;
+    QString eventTarget;
+    QString metricsFile;
+    QString traceFile;
+    QString baseUrl;
+
+    if(!takeOption(arguments, "--path", path))
+    {
+        QTextStream(stderr) << QObject::tr("--path needs a directory") << "\n";
+        return 2;
+    }
+
+    if(!takeOption(arguments, "--events", eventTarget))
+    {
+        QTextStream(stderr) << QObject::tr("--events needs a file or -") << "\n";
+        return 2;
+    }
+
+    if(!takeOption(arguments, "--metrics", metricsFile))
+    {
+        QTextStream(stderr) << QObject::tr("--metrics needs a file") << "\n";
+        return 2;
+    }
+
+    if(!takeOption(arguments, "--trace", traceFile))
+    {
+        QTextStream(stderr) << QObject::tr("--trace needs a file") << "\n";
+        return 2;
+    }
+
+    if(!takeOption(arguments, "--base-url", baseUrl))
+    {
+        QTextStream(stderr) << QObject::tr("--base-url needs an url") << "\n";
+        return 2;
+    }
+
+    // The listener is called on the engine thread, it has to outlive the console
+    QScopedPointer<ROAEventWriter> events;
+
+    if(!eventTarget.isEmpty())
+    {
+        events.reset(openEvents(eventTarget));
+
+        if(events.isNull())
+        {
+            return 2;
+        }
+    }
+
+    ROAConsole console;
+
+    console.setDeepVerify(deep);
+    console.setMetricsFile(metricsFile);
+    console.setTraceFile(traceFile);
+    console.setBaseUrl(baseUrl);
+
+    if(!path.isEmpty())
+    {
+        console.setInstallationPath(path);
+    }
+
+    if(!events.isNull())
+    {
+        console.addListener(events.data());
+
+        // Keep stdout clean for the events
+        console.setLogToStderr(eventTarget == "-");
+    }
+
+    QString action = arguments.isEmpty() ? QString("install") : arguments.at(0);
+
+    if(arguments.size() > 1)
+    {
+        QTextStream(stderr) << QObject::tr("To much arguments!") << "\n";
+        return 2;
+    }
+
+    if(action == "install")
+    {
+        console.run("default");
+    }
+    else if(action == "update" || action == "verify" || action == "repair")
+    {
+        console.run(action);
+    }
+    else if(action == "uninstall")
+    {
+        // Nobody is asked, removing the directory with all its content has to be requested explicitly
+        if(!confirmed)
+        {
+            QTextStream(stderr) << QObject::tr("Uninstalling removes the installation directory with all its content, confirm it with --yes") << "\n";
+            return 2;
+        }
+
+        console.run(action);
+    }
+    else
+    {
+        QTextStream(stderr) << QObject::tr("Wrong argument found!") << "\n";
+        return 2;
+    }
+
+    return a.exec();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAConsole::printLine(QString _text)
+{
+    QTextStream out(logToStderr ? stderr : stdout);
+    out << _text << "\n";
+    out.flush();
+}
+
+void ROAConsole::fail(QString _text, int _code)
+{
+    QTextStream err(stderr);
+    err << _text << "\n";
+    err.flush();
+
+    exitLater(_code);
+}
+
+void ROAConsole::exitLater(int _code)
+{
+    exitCode = _code;
+
+    // QCoreApplication::exit() does nothing before the event loop runs
+    QTimer::singleShot(0, this, SLOT(slot_exit()));
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Slots                                                                   */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAConsole::slot_engineProgress(int _percent, QString _text)
+{
+    // The engine reports ten times per second, a line per percent is enough for logs
+    if(_percent != lastPercent)
+    {
+        lastPercent = _percent;
+        printLine(QString("[%1%] ").arg(_percent, 3) + _text);
+    }
+}
+
+void ROAConsole::slot_engineError(QString _message)
+{
+    QTextStream err(stderr);
+    err << _message << "\n";
+    err.flush();
+}
+
+void ROAConsole::slot_engineFinished(bool _success, QStringList _failedFiles)
+{
+    // The reason was already written by slot_engineError
+    if(!_success)
+    {
+        exitLater(2);
+        return;
+    }
+
+    if(!_failedFiles.isEmpty())
+    {
+        fail(tr("The following files could not be downloaded:\n") + _failedFiles.join("\n"), 1);
+        return;
+    }
+
+    printLine(tr("All files are up to date"));
+    exitLater(0);
+}
+
+void ROAConsole::slot_uninstallFinished(bool _success)
+{
+    if(!_success)
+    {
+        fail(tr("Client uninstalled failed! Please remove left files per hand!"), 1);
+        return;
+    }
+
+    printLine(tr("Client uninstalled successfully!"));
+    exitLater(0);
+}
+
+void ROAConsole::slot_exit()
+{
+    QCoreApplication::exit(exitCode);
+}
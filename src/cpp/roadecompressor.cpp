@@ -0,0 +1,226 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Streaming decompression of downloaded data
+ *
+ * \file    	roadecompressor.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roadecompressor.h"
+
+#include <string.h>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROADecompressor::ROADecompressor(Format _format) :
+    format(_format),
+    zstdContext(0),
+    gzipStream(0),
+    finished(false),
+    failed(false)
+{
+    buffer.resize(ZSTD_DStreamOutSize());
+
+    if(format == Zstd)
+    {
+        zstdContext = ZSTD_createDCtx();
+
+        // Large files and patches use long windows, allow the maximum
+        ZSTD_DCtx_setParameter(zstdContext, ZSTD_d_windowLogMax, sizeof(void*) == 8 ? 31 : 30);
+    }
+    else if(format == Gzip)
+    {
+        gzipStream = new z_stream;
+        memset(gzipStream, 0, sizeof(z_stream));
+
+        // 16 selects the gzip header instead of zlib
+        if(inflateInit2(gzipStream, 16 + MAX_WBITS) != Z_OK)
+        {
+            failed = true;
+        }
+    }
+}
+
+ROADecompressor::~ROADecompressor()
+{
+    if(zstdContext)
+    {
+        ZSTD_freeDCtx(zstdContext);
+    }
+
+    if(gzipStream)
+    {
+        inflateEnd(gzipStream);
+        delete gzipStream;
+    }
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+ROADecompressor::Format ROADecompressor::formatFromSuffix(QString _suffix)
+{
+    if(_suffix == "zst")
+    {
+        return Zstd;
+    }
+    else if(_suffix == "gz")
+    {
+        return Gzip;
+    }
+
+    return None;
+}
+
+void ROADecompressor::setPrefix(const uchar *_data, qint64 _size)
+{
+    if(zstdContext)
+    {
+        ZSTD_DCtx_refPrefix(zstdContext, _data, _size);
+    }
+}
+
+bool ROADecompressor::write(const char *_data, qint64 _size, QIODevice *_target, QCryptographicHash *_hash)
+{
+    if(failed)
+    {
+        return false;
+    }
+
+    if(format == Zstd)
+    {
+        ZSTD_inBuffer input = { _data, (size_t)_size, 0 };
+
+        // A full output buffer means there may be more data pending in the context
+        bool pending = false;
+
+        while(input.pos < input.size || pending)
+        {
+            ZSTD_outBuffer output = { buffer.data(), (size_t)buffer.size(), 0 };
+
+            size_t result = ZSTD_decompressStream(zstdContext, &output, &input);
+
+            if(ZSTD_isError(result))
+            {
+                failed = true;
+                return false;
+            }
+
+            // 0 means a frame is complete, more data starts the next frame
+            finished = (result == 0);
+            pending = (output.pos == output.size);
+
+            _target->write(buffer.constData(), output.pos);
+
+            if(_hash)
+            {
+                _hash->addData(buffer.constData(), output.pos);
+            }
+        }
+    }
+    else if(format == Gzip)
+    {
+        gzipStream->next_in = (Bytef*)_data;
+        gzipStream->avail_in = _size;
+
+        // A full output buffer means there may be more data pending in the stream
+        bool pending = false;
+
+        while(gzipStream->avail_in > 0 || (pending && !finished))
+        {
+            // Concatenated members are valid gzip data
+            if(finished)
+            {
+                inflateReset(gzipStream);
+                finished = false;
+            }
+
+            gzipStream->next_out = (Bytef*)buffer.data();
+            gzipStream->avail_out = buffer.size();
+
+            int result = inflate(gzipStream, Z_NO_FLUSH);
+
+            // No progress without new input is not an error
+            if(result == Z_BUF_ERROR && gzipStream->avail_in == 0)
+            {
+                break;
+            }
+
+            if(result != Z_OK && result != Z_STREAM_END)
+            {
+                failed = true;
+                return false;
+            }
+
+            finished = (result == Z_STREAM_END);
+            pending = (gzipStream->avail_out == 0);
+
+            qint64 size = buffer.size() - gzipStream->avail_out;
+
+            _target->write(buffer.constData(), size);
+
+            if(_hash)
+            {
+                _hash->addData(buffer.constData(), size);
+            }
+        }
+    }
+    else
+    {
+        _target->write(_data, _size);
+
+        if(_hash)
+        {
+            _hash->addData(_data, _size);
+        }
+
+        finished = true;
+    }
+
+    return true;
+}
+
+bool ROADecompressor::isFinished() const
+{
+    return finished && !failed;
+}
@@ -0,0 +1,2425 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Download and verification engine, runs on its own thread
+ *
+ * \file    	roaengine.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roaengine.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constants                                                               */
+/*                                                                            */
+/******************************************************************************/
+
+/**
+ * \brief Size of the chunks written to the disk while downloading
+ */
+static const int DOWNLOAD_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * \brief Maximal amount of data a reply buffers before the transfer is throttled
+ */
+static const qint64 DOWNLOAD_READ_BUFFER_SIZE = 4 * DOWNLOAD_CHUNK_SIZE;
+
+/**
+ * \brief How often a file is requested before the download is given up
+ */
+static const int DOWNLOAD_MAX_ATTEMPTS = 3;
+
+/**
+ * \brief Interval of the status page updates in ms, 10 per second are smooth without slowing down the downloads
+ */
+static const int PROGRESS_UPDATE_INTERVAL = 100;
+
+/**
+ * \brief Data directory on the server if no other is set
+ */
+static const char *DEFAULT_BASE_URL = "https://launcher.annorath-game.com/data/";
+
+/**
+ * \brief Size of the chunks read from the disk while hashing files
+ */
+static const int HASH_CHUNK_SIZE = 256 * 1024;
+
+/**
+ * \brief Hash buffer for each verification thread
+ */
+static QThreadStorage<QByteArray> hashBuffers;
+
+/******************************************************************************/
+/*                                                                            */
+/*    File verifier                                                           */
+/*                                                                            */
+/******************************************************************************/
+
+ROAFileVerifier::ROAFileVerifier(QString _path, const QHash<QString, ROAHashCacheEntry> &_cache, ROATrace *_trace) :
+    installationPath(_path),
+    cache(_cache),
+    trace(_trace)
+{
+}
+
+ROAVerifyJob ROAFileVerifier::operator()(const ROAVerifyJob &_job)
+{
+    qint64 start = trace ? trace->now() : 0;
+
+    ROAVerifyJob result = verify(_job);
+
+    if(trace)
+    {
+        trace->complete("verify", start, _job.file);
+    }
+
+    return result;
+}
+
+ROAVerifyJob ROAFileVerifier::verify(const ROAVerifyJob &_job)
+{
+    ROAVerifyJob result = _job;
+    result.bytes = 0;
+    result.valid = false;
+    result.cacheable = false;
+
+    // Missing files can not be valid
+    if(!ROAHashCache::readStatus(installationPath + _job.file, &result.status))
+    {
+        return result;
+    }
+
+    // Trust the cached hash if the file was not touched since
+    if(cache.contains(_job.file) && ROAHashCache::isValid(cache.value(_job.file), result.status, _job.hash))
+    {
+        result.valid = true;
+        result.cacheable = true;
+        return result;
+    }
+
+    result.valid = ROAEngine::checkFileWithHash(installationPath + _job.file, _job.hash, &result.bytes, &result.localHash);
+
+    // A file written while hashing may match the hash, but the status read before does not describe it
+    ROAHashCacheEntry after;
+
+    result.cacheable = ROAHashCache::readStatus(installationPath + _job.file, &after) && ROAHashCache::isUnchanged(result.status, after);
+
+    return result;
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+ROAVerifyKernel::ROAVerifyKernel(const QList<ROAVerifyJob> &_jobs, ROAFileVerifier _verifier, QThreadPool *_pool) :
+    QtConcurrent::MappedEachKernel<QList<ROAVerifyJob>::const_iterator, ROAFileVerifier>(_jobs.constBegin(), _jobs.constEnd(), _verifier)
+{
+    // The kernel starts its threads on this pool instead of the global one
+    threadPool = _pool;
+}
+#endif
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAEngine::ROAEngine(QObject *parent) :
+    QObject(parent),
+    manager(this),
+    verifyWatcher(this),
+    progressTimer(this)
+{
+    // The certificates are part of the static library, they are not registered automatically
+    Q_INIT_RESOURCE(roaengine);
+
+    // Set download phase for later
+    downloadPhase = 0;
+
+    trace = 0;
+
+    // Buffer for writing downloads in chunks
+    downloadBuffer.resize(DOWNLOAD_CHUNK_SIZE);
+
+    hashedBytes = 0;
+    hashingTime = 0;
+    verifyRunning = false;
+    filesLeft = 0;
+    deepVerify = false;
+    requestCount = 0;
+    tlsHandshakes = 0;
+    encryptedResponses = 0;
+    http2Responses = 0;
+
+    connect(&manager, SIGNAL(finished(QNetworkReply*)),this, SLOT(slot_downloadFinished(QNetworkReply*)));
+    connect(&manager, SIGNAL(sslErrors(QNetworkReply*, const QList<QSslError>&)),this, SLOT(slot_getSSLError(QNetworkReply*, const QList<QSslError>&)));
+    connect(&manager, SIGNAL(encrypted(QNetworkReply*)),this, SLOT(slot_encrypted(QNetworkReply*)));
+
+    // Verification results are handled while the other files are still checked
+    connect(&verifyWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(slot_verifyResultReady(int)));
+    connect(&verifyWatcher, SIGNAL(finished()), this, SLOT(slot_verifyFinished()));
+
+    progressTimer.setInterval(PROGRESS_UPDATE_INTERVAL);
+    connect(&progressTimer, SIGNAL(timeout()), this, SLOT(slot_updateProgress()));
+
+    // A child of the engine, it has to move to the engine thread with it
+    userSettings = new QSettings(QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), "Relics of Annorath Launcher", this);
+
+    /* HTTP/2 multiplexes all requests over a single TLS connection
+     * Opt-in, not every proxy or server handles it well
+     */
+    http2 = userSettings->value("http2", false).toBool();
+
+    /* Amount of parallel downloads, the default matches the connection limit
+     * per host of the network manager for HTTP/1.1
+     * With HTTP/2 they are streams on one connection, more of them hide the latency of small files
+     */
+    maxParallelDownloads = userSettings->value("parallelDownloads", http2 ? 32 : 6).toInt();
+
+    if(maxParallelDownloads < 1)
+    {
+        maxParallelDownloads = 1;
+    }
+
+    /* Large files are split into segments, each is downloaded on its own connection
+     * This helps on links where a single connection can not use the whole bandwidth
+     * The segments share the parallel downloads, they never open more connections
+     */
+    segmentThreshold = userSettings->value("segmentThreshold", 64 * 1024 * 1024).toLongLong();
+    segmentCount = userSettings->value("segmentCount", 4).toInt();
+
+    /* Directories with many small files are downloaded as one bundle
+     * A few missing files are still cheaper to download on their own
+     */
+    bundleThreshold = userSettings->value("bundleThreshold", 8).toInt();
+
+    // Fleets collect the metrics of each run with the textfile collector of the node exporter
+    metricsFile = userSettings->value("metricsFile").toString();
+
+    // Mirrors and test servers use the same layout as the data directory
+    setBaseUrl(userSettings->value("baseUrl", DEFAULT_BASE_URL).toString());
+
+    // Prepare downloading over ssl
+    certificates.append(QSslCertificate::fromPath(":/certs/class2.pem"));
+    certificates.append(QSslCertificate::fromPath(":/certs/ca.pem"));
+
+    sslConfig.defaultConfiguration();
+    sslConfig.setCaCertificates(certificates);
+
+    request.setSslConfiguration(sslConfig);
+
+    // All requests are copies of this one, set explicitly as newer Qt versions allow HTTP/2 by default
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, http2);
+#endif
+
+    /* Amount of verification threads, hashing is bound by the CPU on fast storage
+     * On spinning disks a value of 1 avoids seeking between the files
+     */
+    int verifyThreads = userSettings->value("verifyThreads", QThread::idealThreadCount()).toInt();
+
+    if(verifyThreads > 0)
+    {
+        verifyPool.setMaxThreadCount(verifyThreads);
+    }
+}
+
+ROAEngine::~ROAEngine()
+{
+    delete trace;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAEngine::addListener(ROAEngineListener *_listener)
+{
+    listeners.append(_listener);
+}
+
+void ROAEngine::setMetricsFile(QString _fileName)
+{
+    if(!_fileName.isEmpty())
+    {
+        metricsFile = _fileName;
+    }
+}
+
+void ROAEngine::setTraceFile(QString _fileName)
+{
+    traceFile = _fileName;
+}
+
+void ROAEngine::setBaseUrl(QString _url)
+{
+    if(_url.isEmpty())
+    {
+        return;
+    }
+
+    baseUrl = _url;
+
+    if(!baseUrl.endsWith("/"))
+    {
+        baseUrl += "/";
+    }
+}
+
+void ROAEngine::start(QString _installationPath, QString _mode, bool _deep)
+{
+    installationPath = _installationPath;
+    installationMode = _mode;
+    deepVerify = _deep;
+
+    // Nothing of the last run is carried over, the engine can be started again when it finished
+    downloadPhase = 0;
+    failedFiles.clear();
+    manifestHash.clear();
+    fileStartTimes.clear();
+    waitingRequests.clear();
+    hashedBytes = 0;
+    hashingTime = 0;
+    requestCount = 0;
+    tlsHandshakes = 0;
+    encryptedResponses = 0;
+    http2Responses = 0;
+
+    runTimer.start();
+    metrics.reset();
+
+    if(!traceFile.isEmpty())
+    {
+        delete trace;
+        trace = new ROATrace(traceFile);
+
+        if(!trace->isOpen())
+        {
+            qWarning() << "Could not open the trace file" << traceFile;
+
+            delete trace;
+            trace = 0;
+        }
+    }
+
+    // Repairing starts from scratch for the game content
+    if(installationMode == "repair" && !removeDirWithContent(installationPath + "game"))
+    {
+        stopRun(tr("Please remove the \"game\" folder under ") + installationPath + tr("!"));
+        return;
+    }
+
+    // Check for needed dirs and create them if needed
+    checkDirectories();
+
+    // Get file list for verification, after this point everything is handled with slots
+    getRemoteFileList();
+}
+
+void ROAEngine::uninstall(QString _installationPath)
+{
+    bool success = removeDirWithContent(_installationPath);
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->uninstallFinished(success);
+    }
+
+    emit uninstallFinished(success);
+}
+
+double ROAEngine::getHashThroughput()
+{
+    if(hashingTime <= 0)
+    {
+        return 0;
+    }
+
+    return (hashedBytes / (1024.0 * 1024.0)) / (hashingTime / 1000000000.0);
+}
+
+bool ROAEngine::checkFileWithHash(QString _file, QString _hash, qint64 *_hashedBytes, QString *_localHash)
+{
+    QFile file(_file);
+
+    if(file.open(QIODevice::ReadOnly))
+    {
+        // Every thread reuses its own buffer
+        QByteArray &buffer = hashBuffers.localData();
+
+        if(buffer.size() != HASH_CHUNK_SIZE)
+        {
+            buffer.resize(HASH_CHUNK_SIZE);
+        }
+
+        // Hash the file chunk by chunk
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+
+        qint64 size;
+
+        while((size = file.read(buffer.data(), buffer.size())) > 0)
+        {
+            hash.addData(buffer.constData(), size);
+
+            if(_hashedBytes)
+            {
+                *_hashedBytes += size;
+            }
+        }
+
+        if(size != 0)
+        {
+            return false;
+        }
+
+        QString result = QString(hash.result().toHex());
+
+        if(_localHash)
+        {
+            *_localHash = result;
+        }
+
+        // Compare
+        if(result == _hash)
+        {
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+}
+
+bool ROAEngine::removeDirWithContent(QString _dir)
+{
+    // Thanks to John for the code part -> http://john.nachtimwald.com/2010/06/08/qt-remove-directory-and-its-contents/
+    bool result = true;
+
+    QDir dir(_dir);
+
+    if (dir.exists(_dir))
+    {
+        Q_FOREACH(QFileInfo info, dir.entryInfoList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst))
+        {
+            if (info.isDir())
+            {
+                result = removeDirWithContent(info.absoluteFilePath());
+            }
+            else
+            {
+                result = QFile::remove(info.absoluteFilePath());
+            }
+
+            if (!result) {
+                return result;
+            }
+        }
+
+        result = dir.rmdir(_dir);
+    }
+
+    return result;
+}
+
+bool ROAEngine::parseFileList(QString _fileName, QList<ROAVerifyJob> *_jobs, QStringList *_bundles)
+{
+    // Open file and read it
+    QFile file(_fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // Map the file, the entries point into it and no line is copied
+    qint64 size = file.size();
+    uchar *mapped = (size > 0) ? file.map(0, size) : 0;
+
+    QByteArray content;
+
+    if(!mapped)
+    {
+        content = file.readAll();
+        size = content.size();
+    }
+
+    ROAFileListParser parser(mapped ? reinterpret_cast<const char*>(mapped) : content.constData(), size);
+    ROAFileListEntry entry;
+
+    while(parser.next(&entry))
+    {
+        if(entry.bundle)
+        {
+            _bundles->append(entry.file.toString());
+            continue;
+        }
+
+        ROAVerifyJob job;
+        job.file = entry.file.toString();
+        job.hash = entry.hash.toString();
+        job.size = ROAFileListParser::toNumber(entry.size);
+
+        if(!entry.patches.isEmpty())
+        {
+            // QString::SkipEmptyParts is deprecated since Qt 5.14 and removed in Qt 6
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+            job.patches = entry.patches.toString().split(",", Qt::SkipEmptyParts);
+#else
+            job.patches = entry.patches.toString().split(",", QString::SkipEmptyParts);
+#endif
+        }
+
+        if(!entry.compression.isEmpty())
+        {
+            QString suffix = entry.compression.toString();
+
+            if(ROADecompressor::formatFromSuffix(suffix) != ROADecompressor::None)
+            {
+                job.compression = suffix;
+            }
+        }
+
+        if(!entry.chunks.isEmpty())
+        {
+            job.chunkIndex = entry.chunks.toString();
+        }
+
+        job.valid = false;
+        job.bytes = 0;
+
+        _jobs->append(job);
+    }
+
+    if(mapped)
+    {
+        file.unmap(mapped);
+    }
+
+    // Close file
+    file.close();
+
+    return true;
+}
+
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAEngine::checkDirectories()
+{
+    QStringList dirs;
+    dirs << installationPath + "game"
+         << installationPath + "game/bin"
+         << installationPath + "game/data"
+         << installationPath + "game/lib"
+         << installationPath + "launcher"
+         << installationPath + "launcher/platforms"
+        #ifdef Q_OS_LINUX
+         << installationPath + "launcher/bin"
+         << installationPath + "launcher/lib"
+         << installationPath + "launcher/bin/platforms"
+         << installationPath + "launcher/bin/imageformats"
+        #endif
+         << installationPath + "launcher/downloads"
+         << installationPath + "launcher/imageformats"
+         << installationPath + "launcher/sounds";
+
+    for(int i = 0; i < dirs.size(); i++)
+    {
+        QDir dir(dirs.at(i));
+        if(!dir.exists())
+            QDir().mkpath(dirs.at(i));
+    }
+}
+
+void ROAEngine::getRemoteFileList()
+{
+    setPhase("manifest");
+    metrics.begin("manifest");
+
+    // The file list is named after the platform
+    request.setUrl(getFileUrl("launcher/" + getPlatform() + ".txt"));
+
+    // Start download
+    startDownload("launcher/downloads/files.txt", -1);
+}
+
+void ROAEngine::prepareDownload()
+{
+    metrics.end("manifest");
+    metrics.addFiles("manifest", 1);
+    metrics.addBytes("manifest", QFileInfo(installationPath + "launcher/downloads/files.txt").size());
+
+    setPhase("verify");
+    metrics.begin("verify");
+
+    // Downloads start with the first broken file, they run next to the verification
+    metrics.begin("download");
+
+    QList<ROAVerifyJob> jobs;
+
+    // Nothing to download yet, the verification results fill the queue
+    fileList.clear();
+    fileListMD5.clear();
+    fileListSize.clear();
+    fileListPatch.clear();
+    fileListCompression.clear();
+    fileListChunks.clear();
+    filesLeft = 0;
+
+    chunkIndexes.clear();
+
+    bundles.clear();
+    bundleMissing.clear();
+
+    progress.reset();
+    currentFile.clear();
+    progressTimer.start();
+
+    // Load the hashes of the last run, unchanged files are not hashed again
+    hashCache.load(installationPath + "launcher/downloads/hashcache.txt");
+
+    // Load the chunks of the installed files for reusing them
+    chunkStore.load(installationPath);
+
+    /* On updates only the changes against the installed release are checked
+     * If the file list is unchanged there is nothing to do at all
+     */
+    QHash<QString, QString> installed;
+
+    if(installationMode == "update" && !deepVerify)
+    {
+        QString installedHash;
+
+        installed = loadInstalledManifest(&installedHash);
+
+        if(!installed.isEmpty() && !manifestHash.isEmpty() && manifestHash == installedHash)
+        {
+            verifyRunning = false;
+            getNextFile();
+
+            return;
+        }
+    }
+
+    // Read the file list
+    parseFileList(installationPath + "launcher/downloads/files.txt", &jobs, &bundles);
+
+    // Skip files which did not change since the installed release
+    if(!installed.isEmpty())
+    {
+        QList<ROAVerifyJob> changed;
+
+        foreach(const ROAVerifyJob &job, jobs)
+        {
+            if(installed.value(job.file) != job.hash)
+            {
+                changed.append(job);
+            }
+        }
+
+        jobs = changed;
+    }
+
+    // Check for correct files on the thread pool, do not download not needed data
+    hashedBytes = 0;
+    verifyRunning = true;
+    verifyTimer.start();
+
+    // The deep verification ignores the hash cache
+    ROAFileVerifier verifier(installationPath, deepVerify ? QHash<QString, ROAHashCacheEntry>() : hashCache.getEntries(), trace);
+
+    verifyJobs = jobs;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    verifyWatcher.setFuture(QtConcurrent::mapped(&verifyPool, verifyJobs, verifier));
+#else
+    verifyWatcher.setFuture(QtConcurrent::startThreadEngine(new ROAVerifyKernel(verifyJobs, verifier, &verifyPool)));
+#endif
+}
+
+QHash<QString, QString> ROAEngine::loadInstalledManifest(QString *_hash)
+{
+    QHash<QString, QString> installed;
+
+    QFile file(installationPath + "launcher/downloads/installed.txt");
+
+    if (file.open(QIODevice::ReadOnly))
+    {
+        QByteArray content = file.readAll();
+
+        // The installed file list is a copy of the downloaded one, the hashes of both match if the release is unchanged
+        *_hash = QString(QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex());
+
+        ROAFileListParser parser(content.constData(), content.size());
+        ROAFileListEntry entry;
+
+        while(parser.next(&entry))
+        {
+            if(!entry.bundle)
+            {
+                installed.insert(entry.file.toString(), entry.hash.toString());
+            }
+        }
+    }
+
+    file.close();
+
+    return installed;
+}
+
+void ROAEngine::saveInstalledManifest()
+{
+    // Only a completely applied file list is a valid installed release
+    if(manifestHash.isEmpty() || !failedFiles.isEmpty())
+    {
+        return;
+    }
+
+    QFile::remove(installationPath + "launcher/downloads/installed.txt");
+    QFile::copy(installationPath + "launcher/downloads/files.txt", installationPath + "launcher/downloads/installed.txt");
+}
+
+void ROAEngine::getNextFile()
+{
+    // Fill up all free download slots
+    while((!segmentQueue.isEmpty() || !fallbackQueue.isEmpty() || !chunkQueue.isEmpty() || filesLeft > 0 || (!verifyRunning && !indexQueue.isEmpty())) && getRunningRequests() < maxParallelDownloads)
+    {
+        // Waiting segments, fallbacks and missing chunks first, they complete files which are already started
+        if(!segmentQueue.isEmpty())
+        {
+            ROASegmentRequest segmentRequest = segmentQueue.takeFirst();
+            ROASegmentedDownload *segmented = segmentRequest.segmented;
+
+            segmented->waiting -= 1;
+
+            // The file falls back to a single stream anyway
+            if(segmented->failed)
+            {
+                if(segmented->running == 0 && segmented->waiting == 0)
+                {
+                    completeSegmentedDownload(segmented);
+                }
+
+                continue;
+            }
+
+            startSegment(segmented, segmentRequest.segment);
+            continue;
+        }
+
+        if(!fallbackQueue.isEmpty())
+        {
+            startFullDownload(fallbackQueue.takeFirst());
+            continue;
+        }
+
+        if(!chunkQueue.isEmpty())
+        {
+            startChunk(chunkQueue.takeFirst());
+            continue;
+        }
+
+        // Chunk indexes of installed files after all broken files, they only help later updates
+        if(filesLeft == 0)
+        {
+            startChunkIndex(indexQueue.takeFirst());
+            continue;
+        }
+
+        // The files are downloaded in the order they were queued
+        int index = fileList.size() - filesLeft;
+
+        if(!fileListPatch.at(index).isEmpty())
+        {
+            // The patch is stored next to the file, named after the release it applies to
+            request.setUrl(getFileUrl(fileList.at(index) + "." + fileListPatch.at(index) + ".patch"));
+            startDownload(fileList.at(index) + ".patch", index, 1, ROADownloadPatch);
+        }
+        else if(!fileListChunks.at(index).isEmpty())
+        {
+            // The chunk index is stored next to the file
+            request.setUrl(getFileUrl(fileList.at(index) + ".chunks"));
+            startDownload(fileList.at(index) + ".chunks", index, 1, ROADownloadChunkIndex);
+        }
+        else
+        {
+            startFullDownload(index);
+        }
+
+        // Shown with the next status update
+        currentFile = fileList.at(index);
+        startFile(currentFile);
+
+        filesLeft -= 1;
+    }
+
+    // Everything verified and requested and all running downloads are done
+    if(!verifyRunning && filesLeft == 0 && getRunningRequests() == 0 && segmentQueue.isEmpty() && fallbackQueue.isEmpty() && chunkQueue.isEmpty() && indexQueue.isEmpty())
+    {
+        progressTimer.stop();
+        setPhase("done");
+
+        metrics.endAll();
+        metrics.begin("postinstall");
+
+        // Remember the verified hashes, the chunks and the installed release for the next run
+        hashCache.save();
+        chunkStore.save();
+        saveInstalledManifest();
+
+        metrics.end("postinstall");
+
+        // Connections are reused, a handshake per encrypted response means the reuse does not work
+        metrics.setValue("run_seconds", runTimer.elapsed() / 1000.0);
+        metrics.setValue("requests", requestCount);
+        metrics.setValue("tls_handshakes", tlsHandshakes);
+        metrics.setValue("encrypted_responses", encryptedResponses);
+        metrics.setValue("http2_responses", http2Responses);
+        metrics.setValue("failed_files", failedFiles.size());
+
+        foreach(QString line, metrics.getSummary())
+        {
+            qDebug() << qPrintable(line);
+        }
+
+        if(!metricsFile.isEmpty() && !metrics.writePrometheus(metricsFile))
+        {
+            qWarning() << "Could not write the metrics to" << metricsFile;
+        }
+
+        // The verification is done, nothing else writes to the trace
+        delete trace;
+        trace = 0;
+
+        waitingRequests.clear();
+
+        QMap<QString, double> values = metrics.getValues();
+
+        foreach(ROAEngineListener *listener, listeners)
+        {
+            listener->metricsReported(values);
+            listener->finished(true, failedFiles);
+        }
+
+        // The results are shown on the GUI thread
+        emit finished(true, failedFiles);
+    }
+}
+
+QUrl ROAEngine::getFileUrl(QString _file)
+{
+    return QUrl(baseUrl + getPlatform() + "/" + _file);
+}
+
+QString ROAEngine::getPlatform()
+{
+#ifdef Q_OS_LINUX
+#ifdef __x86_64__
+    return "linux_x86_64";
+#else
+    return "linux_x86";
+#endif
+#endif
+
+#ifdef Q_OS_WIN32
+#ifdef Q_OS_WIN64
+    return "windows_x86_64";
+#else
+    return "windows_x86";
+#endif
+#endif
+
+    return QString();
+}
+
+void ROAEngine::startFullDownload(int _index)
+{
+    if(!fileListCompression.at(_index).isEmpty())
+    {
+        // The compressed file is stored next to the file
+        request.setUrl(getFileUrl(fileList.at(_index) + "." + fileListCompression.at(_index)));
+        startDownload(fileList.at(_index), _index);
+    }
+    else if(segmentCount > 1 && fileListSize.at(_index) >= qMax<qint64>(segmentThreshold, segmentCount))
+    {
+        // Each segment gets at least one byte, empty ranges can not be requested
+        request.setUrl(getFileUrl(fileList.at(_index)));
+        startSegmentedDownload(fileList.at(_index), _index);
+    }
+    else
+    {
+        request.setUrl(getFileUrl(fileList.at(_index)));
+        startDownload(fileList.at(_index), _index);
+    }
+}
+
+void ROAEngine::queueFile(const ROAVerifyJob &_job)
+{
+    fileList.append(_job.file);
+    fileListMD5.append(_job.hash);
+    fileListSize.append(_job.size);
+    fileListCompression.append(_job.compression);
+    fileListChunks.append(_job.chunkIndex);
+    filesLeft += 1;
+
+    // Patch the local file on updates if the server has a patch for its release
+    if(installationMode == "update" && !_job.localHash.isEmpty() && _job.patches.contains(_job.localHash))
+    {
+        fileListPatch.append(_job.localHash);
+    }
+    else
+    {
+        fileListPatch.append(QString());
+    }
+}
+
+void ROAEngine::startBundleDownload(QString _directory)
+{
+    // Only the missing files are extracted, with the hashes from the file list
+    QHash<QString, QString> members;
+
+    foreach(const ROAVerifyJob &job, bundleMissing.value(_directory))
+    {
+        members.insert(job.file, job.hash);
+        startFile(job.file);
+    }
+
+    ROADownload download;
+    download.index = -1;
+    download.fileName = _directory;
+    download.file = 0;
+    download.hash = 0;
+    download.attempt = 1;
+    download.offset = 0;
+    download.headersHandled = false;
+    download.accepted = false;
+    download.segmented = 0;
+    download.segment = -1;
+    download.type = ROADownloadBundle;
+    download.decompressor = new ROADecompressor(ROADecompressor::Zstd);
+    download.extractor = new ROATarExtractor(installationPath, members);
+
+    QNetworkRequest bundleRequest = request;
+    bundleRequest.setUrl(getFileUrl(_directory + ".tar.zst"));
+
+    QNetworkReply *reply = manager.get(bundleRequest);
+
+    // Keep the memory usage constant, the data is extracted as it arrives
+    reply->setReadBufferSize(DOWNLOAD_READ_BUFFER_SIZE);
+
+    connect(reply, SIGNAL(readyRead()), this, SLOT(slot_downloadReadyRead()));
+
+    traceRequest(reply);
+
+    activeDownloads.insert(reply, download);
+}
+
+void ROAEngine::writeBundleData(QNetworkReply *_reply, ROADownload &_download)
+{
+    if(!_download.headersHandled)
+    {
+        _download.headersHandled = true;
+        _download.accepted = (_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200);
+    }
+
+    while(_reply->bytesAvailable() > 0)
+    {
+        qint64 size = _reply->read(downloadBuffer.data(), downloadBuffer.size());
+
+        if(size <= 0)
+        {
+            break;
+        }
+
+        // Drop error pages and the rest of broken data
+        if(_download.accepted && !_download.decompressor->write(downloadBuffer.constData(), size, _download.extractor))
+        {
+            _download.accepted = false;
+        }
+    }
+
+    // The progress counts the members as they are extracted, the bundle itself is not a file of the progress
+    QHash<QString, qint64> written = _download.extractor->takeWrittenBytes();
+    QHash<QString, qint64>::const_iterator i;
+
+    for(i = written.constBegin(); i != written.constEnd(); ++i)
+    {
+        progress.addReceived(i.key(), i.value());
+    }
+}
+
+void ROAEngine::finishBundle(QNetworkReply *_reply, ROADownload &_download)
+{
+    writeBundleData(_reply, _download);
+
+    /* Each extracted file was verified against the file list on its own
+     * They are installed even if the bundle broke later, the rest is downloaded file by file
+     */
+    QStringList extracted = _download.extractor->getExtractedFiles();
+
+    // Removes the partial file of an incomplete member
+    delete _download.extractor;
+    delete _download.decompressor;
+
+    foreach(const ROAVerifyJob &job, bundleMissing.take(_download.fileName))
+    {
+        if(!extracted.contains(job.file) || !installDownloadedFile(job.file, job.hash))
+        {
+            QFile::remove(installationPath + job.file + ".part");
+            queueFile(job);
+        }
+    }
+}
+
+void ROAEngine::startDownload(QString _fileName, int _index, int _attempt, ROADownloadType _type)
+{
+    ROADownload download;
+    download.index = _index;
+    download.fileName = _fileName;
+    download.attempt = _attempt;
+    download.hash = new QCryptographicHash(QCryptographicHash::Sha256);
+    download.offset = 0;
+    download.headersHandled = false;
+    download.accepted = false;
+    download.segmented = 0;
+    download.segment = -1;
+    download.type = _type;
+    download.decompressor = 0;
+    download.extractor = 0;
+
+    // Compressed files are decompressed while downloading, patches are compressed on their own
+    if(_index >= 0 && _type == ROADownloadFile && !fileListCompression.at(_index).isEmpty())
+    {
+        download.decompressor = new ROADecompressor(ROADecompressor::formatFromSuffix(fileListCompression.at(_index)));
+    }
+
+    // Every download gets its own headers
+    QNetworkRequest fileRequest = request;
+
+    // The temporary file, the real file is replaced after verifying
+    download.file = new QFile(installationPath + _fileName + ".part");
+
+    // The validator of the partial file, without it we can not resume safely
+    QString validator;
+    QFile meta(download.file->fileName() + ".meta");
+
+    if(meta.open(QIODevice::ReadOnly))
+    {
+        validator = QString::fromUtf8(meta.readAll()).trimmed();
+        meta.close();
+    }
+
+    // The partial file of a compressed download does not match the offset on the server
+    if(!validator.isEmpty() && !download.decompressor && download.file->size() > 0 && download.file->open(QIODevice::ReadWrite))
+    {
+        // Hash the data we already got, new data is appended
+        qint64 size;
+
+        while((size = download.file->read(downloadBuffer.data(), downloadBuffer.size())) > 0)
+        {
+            download.hash->addData(downloadBuffer.constData(), size);
+            download.offset += size;
+        }
+
+        // Only request the missing part if the file on the server is unchanged
+        fileRequest.setRawHeader("Range", "bytes=" + QByteArray::number(download.offset) + "-");
+        fileRequest.setRawHeader("If-Range", validator.toUtf8());
+    }
+    else
+    {
+        QFile::remove(meta.fileName());
+        download.file->open(QIODevice::WriteOnly);
+    }
+
+    QNetworkReply *reply = manager.get(fileRequest);
+
+    // Keep the memory usage constant, the data is written to the disk as it arrives
+    reply->setReadBufferSize(DOWNLOAD_READ_BUFFER_SIZE);
+
+    connect(reply, SIGNAL(readyRead()), this, SLOT(slot_downloadReadyRead()));
+
+    traceRequest(reply);
+
+    // Remember which file belongs to the reply
+    activeDownloads.insert(reply, download);
+}
+
+void ROAEngine::handleDownloadHeaders(QNetworkReply *_reply, ROADownload &_download)
+{
+    _download.headersHandled = true;
+
+    int status = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if(status == 206 && _download.offset > 0)
+    {
+        // The missing part is appended
+        _download.accepted = true;
+    }
+    else if(status == 200)
+    {
+        // The server sent the whole file, start from the beginning
+        if(_download.offset > 0)
+        {
+            _download.file->resize(0);
+            _download.file->seek(0);
+            _download.hash->reset();
+            _download.offset = 0;
+        }
+
+        _download.accepted = true;
+    }
+    else
+    {
+        // Error pages are never written
+        _download.accepted = false;
+        return;
+    }
+
+    // Files without a size in the file list count with the size sent by the server
+    if(_download.index >= 0 && _download.type == ROADownloadFile && !_download.decompressor)
+    {
+        progress.setFileSize(fileList.at(_download.index), _download.offset + _reply->header(QNetworkRequest::ContentLengthHeader).toLongLong());
+    }
+
+    // Store the validator, an interrupted download is resumed from here
+    QByteArray validator = _reply->rawHeader("ETag");
+
+    if(validator.isEmpty())
+    {
+        validator = _reply->rawHeader("Last-Modified");
+    }
+
+    // Compressed downloads are not resumed
+    if(_download.decompressor)
+    {
+        validator.clear();
+    }
+
+    QFile meta(_download.file->fileName() + ".meta");
+
+    if(!validator.isEmpty() && meta.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        meta.write(validator);
+        meta.close();
+    }
+    else
+    {
+        QFile::remove(meta.fileName());
+    }
+}
+
+void ROAEngine::writeDownloadData(QNetworkReply *_reply, ROADownload &_download)
+{
+    if(_download.segmented)
+    {
+        writeSegmentData(_reply, _download);
+        return;
+    }
+
+    if(_download.extractor)
+    {
+        writeBundleData(_reply, _download);
+        return;
+    }
+
+    if(!_download.headersHandled)
+    {
+        handleDownloadHeaders(_reply, _download);
+    }
+
+    while(_reply->bytesAvailable() > 0)
+    {
+        qint64 size = _reply->read(downloadBuffer.data(), downloadBuffer.size());
+
+        if(size <= 0)
+        {
+            break;
+        }
+
+        // Patches and chunk indexes count for the file they belong to
+        progress.addReceived((_download.index >= 0) ? fileList.at(_download.index) : _download.fileName, size);
+
+        // Drop the body of error responses
+        if(!_download.accepted)
+        {
+            continue;
+        }
+
+        if(_download.decompressor)
+        {
+            // Broken data, drop the rest of the response
+            if(!_download.decompressor->write(downloadBuffer.constData(), size, _download.file, _download.hash))
+            {
+                _download.accepted = false;
+            }
+        }
+        else
+        {
+            _download.file->write(downloadBuffer.constData(), size);
+            _download.hash->addData(downloadBuffer.constData(), size);
+        }
+    }
+}
+
+bool ROAEngine::commitDownload(QNetworkReply *_reply, const ROADownload &_download)
+{
+    // Compressed downloads can not be resumed, the stream must be complete
+    if(_download.decompressor && (_reply->error() != QNetworkReply::NoError || !_download.accepted || !_download.decompressor->isFinished()))
+    {
+        QFile::remove(_download.file->fileName());
+        return false;
+    }
+
+    // Keep the data of aborted transfers, the next attempt resumes it
+    if(_reply->error() != QNetworkReply::NoError || !_download.accepted)
+    {
+        // The partial file does not fit to the file on the server
+        if(_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 416)
+        {
+            QFile::remove(_download.file->fileName());
+            QFile::remove(_download.file->fileName() + ".meta");
+        }
+
+        return false;
+    }
+
+    // Patches are verified after applying them, chunk indexes have their own hash
+    if(_download.type != ROADownloadFile)
+    {
+        if(_download.type == ROADownloadChunkIndex && QString(_download.hash->result().toHex()) != fileListChunks.at(_download.index))
+        {
+            QFile::remove(_download.file->fileName());
+            QFile::remove(_download.file->fileName() + ".meta");
+            return false;
+        }
+
+        QFile::remove(_download.file->fileName() + ".meta");
+        QFile::remove(installationPath + _download.fileName);
+
+        return QFile::rename(_download.file->fileName(), installationPath + _download.fileName);
+    }
+
+    // Compare with the hash from the file list, the file list itself has no hash
+    if(_download.index >= 0 && QString(_download.hash->result().toHex()) != fileListMD5.at(_download.index))
+    {
+        QFile::remove(_download.file->fileName());
+        QFile::remove(_download.file->fileName() + ".meta");
+        return false;
+    }
+
+    QFile::remove(_download.file->fileName() + ".meta");
+
+    if(!installDownloadedFile(_download.fileName, (_download.index >= 0) ? fileListMD5.at(_download.index) : QString()))
+    {
+        return false;
+    }
+
+    // Remember the hash of the file list to detect unchanged releases
+    if(_download.index < 0)
+    {
+        manifestHash = QString(_download.hash->result().toHex());
+    }
+
+    return true;
+}
+
+bool ROAEngine::installDownloadedFile(QString _fileName, QString _hash, QString _suffix)
+{
+    // Replace the old file
+    QFile::remove(installationPath + _fileName);
+
+    if(!QFile::rename(installationPath + _fileName + _suffix, installationPath + _fileName))
+    {
+        return false;
+    }
+
+    // The chunks of the old file are gone, the new one is indexed if the file list has a chunk index for it
+    chunkStore.removeFile(_fileName);
+    queueChunkIndex(_fileName);
+
+    // The data was hashed while downloading, no need to hash it again on the next run
+    ROAHashCacheEntry entry;
+
+    if(!_hash.isEmpty() && ROAHashCache::readStatus(installationPath + _fileName, &entry))
+    {
+        entry.hash = _hash;
+        hashCache.insert(_fileName, entry);
+    }
+
+    // The file list itself is not part of the progress
+    if(!_hash.isEmpty())
+    {
+        finishFile(_fileName, true);
+    }
+
+    return true;
+}
+
+bool ROAEngine::applyPatch(int _index)
+{
+    QString target = installationPath + fileList.at(_index);
+
+    QFile oldFile(target);
+    QFile patchFile(target + ".patch");
+
+    // Not the .part file, it may hold an interrupted download of the file which is resumed later
+    QFile newFile(target + ".patched");
+
+    if(!oldFile.open(QIODevice::ReadOnly) || !patchFile.open(QIODevice::ReadOnly) || !newFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    // Map the old file, it is referenced by the patch as a whole
+    uchar *oldData = 0;
+
+    if(oldFile.size() > 0)
+    {
+        oldData = oldFile.map(0, oldFile.size());
+
+        if(!oldData)
+        {
+            return false;
+        }
+    }
+
+    // The old file is the prefix of the patch
+    ROADecompressor decompressor(ROADecompressor::Zstd);
+    decompressor.setPrefix(oldData, oldFile.size());
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    bool success = true;
+    qint64 size;
+
+    // Stream the patch through the decompressor into the new file
+    while(success && (size = patchFile.read(downloadBuffer.data(), downloadBuffer.size())) > 0)
+    {
+        success = decompressor.write(downloadBuffer.constData(), size, &newFile, &hash);
+    }
+
+    // The frame must be complete
+    if(!decompressor.isFinished())
+    {
+        success = false;
+    }
+
+    newFile.setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+    newFile.close();
+    patchFile.close();
+
+    if(oldData)
+    {
+        oldFile.unmap(oldData);
+    }
+
+    oldFile.close();
+
+    // The patch is not needed anymore
+    QFile::remove(patchFile.fileName());
+
+    if(!success || QString(hash.result().toHex()) != fileListMD5.at(_index))
+    {
+        QFile::remove(newFile.fileName());
+        return false;
+    }
+
+    return installDownloadedFile(fileList.at(_index), fileListMD5.at(_index), ".patched");
+}
+
+bool ROAEngine::assembleChunkedFile(int _index)
+{
+    QString indexFile = installationPath + fileList.at(_index) + ".chunks";
+
+    QList<ROAChunk> chunks;
+    bool valid = ROAChunkStore::readIndex(indexFile, &chunks);
+
+    QFile::remove(indexFile);
+
+    if(!valid)
+    {
+        return false;
+    }
+
+    ROAChunkedDownload *download = new ROAChunkedDownload;
+    download->index = _index;
+    download->chunks = chunks;
+    download->running = 0;
+    download->failed = false;
+
+    // Preallocate the file, the chunks are written at their offsets
+    qint64 size = 0;
+
+    for(int i = 0; i < chunks.size(); i++)
+    {
+        size += chunks.at(i).size;
+    }
+
+    // A partial file of a normal download can not be resumed from a preallocated file
+    QFile::remove(installationPath + fileList.at(_index) + ".part.meta");
+
+    download->file = new QFile(installationPath + fileList.at(_index) + ".part");
+
+    if(!download->file->open(QIODevice::ReadWrite | QIODevice::Truncate) || !download->file->resize(size))
+    {
+        download->file->close();
+        download->file->remove();
+
+        delete download->file;
+        delete download;
+
+        return false;
+    }
+
+    QByteArray data;
+    qint64 offset = 0;
+
+    for(int i = 0; i < chunks.size(); i++)
+    {
+        const ROAChunk &chunk = chunks.at(i);
+
+        if(download->missing.contains(chunk.hash))
+        {
+            // Already requested, write it here too when it arrives
+            download->missing[chunk.hash].append(offset);
+        }
+        else if(chunkStore.readChunk(chunk, &data))
+        {
+            // Reuse the chunk of an installed file
+            download->file->seek(offset);
+            download->file->write(data);
+        }
+        else
+        {
+            download->missing.insert(chunk.hash, QList<qint64>() << offset);
+
+            ROAChunkRequest chunkRequest;
+            chunkRequest.download = download;
+            chunkRequest.chunk = chunk;
+            chunkRequest.attempt = 1;
+
+            chunkQueue.append(chunkRequest);
+            download->running += 1;
+        }
+
+        offset += chunk.size;
+    }
+
+    // Everything was available locally
+    if(download->running == 0)
+    {
+        finishChunkedDownload(download);
+    }
+
+    return true;
+}
+
+void ROAEngine::startChunk(const ROAChunkRequest &_request)
+{
+    ROAChunkedDownload *download = _request.download;
+
+    // Do not download chunks of files which already failed
+    if(download->failed)
+    {
+        download->running -= 1;
+
+        if(download->running == 0)
+        {
+            finishChunkedDownload(download);
+        }
+
+        return;
+    }
+
+    // Chunks are stored zstd compressed, grouped by the start of their hash
+    QNetworkRequest chunkRequest = request;
+    chunkRequest.setUrl(getFileUrl("chunks/" + _request.chunk.hash.left(4) + "/" + _request.chunk.hash + ".zst"));
+
+    QNetworkReply *reply = manager.get(chunkRequest);
+
+    traceRequest(reply);
+
+    chunkDownloads.insert(reply, _request);
+}
+
+void ROAEngine::finishChunk(QNetworkReply *_reply)
+{
+    ROAChunkRequest chunkRequest = chunkDownloads.take(_reply);
+    ROAChunkedDownload *download = chunkRequest.download;
+
+    bool valid = false;
+
+    if(_reply->error() == QNetworkReply::NoError && !download->failed)
+    {
+        // Chunks are small, they are decompressed in memory
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        ROADecompressor decompressor(ROADecompressor::Zstd);
+
+        QByteArray compressed = _reply->readAll();
+
+        progress.addReceived(fileList.at(download->index), compressed.size());
+
+        valid = decompressor.write(compressed.constData(), compressed.size(), &buffer, &hash)
+                && decompressor.isFinished()
+                && data.size() == chunkRequest.chunk.size
+                && QString(hash.result().toHex()) == chunkRequest.chunk.hash;
+
+        if(valid)
+        {
+            // Write the chunk at every place it is used
+            QList<qint64> offsets = download->missing.value(chunkRequest.chunk.hash);
+
+            for(int i = 0; i < offsets.size(); i++)
+            {
+                download->file->seek(offsets.at(i));
+                download->file->write(data);
+            }
+        }
+    }
+
+    if(!valid && !download->failed)
+    {
+        if(chunkRequest.attempt < DOWNLOAD_MAX_ATTEMPTS)
+        {
+            // Queue the chunk again
+            chunkRequest.attempt += 1;
+            chunkQueue.append(chunkRequest);
+
+            return;
+        }
+
+        download->failed = true;
+    }
+
+    download->running -= 1;
+
+    if(download->running == 0)
+    {
+        finishChunkedDownload(download);
+    }
+}
+
+void ROAEngine::finishChunkedDownload(ROAChunkedDownload *_download)
+{
+    int index = _download->index;
+
+    _download->file->setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+    _download->file->close();
+
+    bool committed = false;
+
+    // The chunks were written out of order, hash the assembled file once
+    if(!_download->failed && checkFileWithHash(_download->file->fileName(), fileListMD5.at(index)))
+    {
+        committed = installDownloadedFile(fileList.at(index), fileListMD5.at(index));
+    }
+
+    if(committed)
+    {
+        // The chunks of this file can be reused by later releases
+        chunkStore.addFile(fileList.at(index), _download->chunks);
+    }
+    else
+    {
+        QFile::remove(_download->file->fileName());
+
+        // Fall back to the whole file, it waits for a free slot like the chunks did
+        fallbackQueue.append(index);
+    }
+
+    delete _download->file;
+    delete _download;
+}
+
+void ROAEngine::queueChunkIndex(QString _file)
+{
+    if(!chunkIndexes.contains(_file) || chunkStore.contains(_file))
+    {
+        return;
+    }
+
+    ROAChunkIndexRequest indexRequest;
+    indexRequest.file = _file;
+    indexRequest.hash = chunkIndexes.value(_file);
+    indexRequest.attempt = 1;
+
+    indexQueue.append(indexRequest);
+}
+
+void ROAEngine::startChunkIndex(const ROAChunkIndexRequest &_request)
+{
+    // Files assembled from chunks are known already
+    if(chunkStore.contains(_request.file))
+    {
+        return;
+    }
+
+    // The chunk index is stored next to the file
+    QNetworkRequest indexRequest = request;
+    indexRequest.setUrl(getFileUrl(_request.file + ".chunks"));
+
+    QNetworkReply *reply = manager.get(indexRequest);
+
+    traceRequest(reply);
+
+    indexDownloads.insert(reply, _request);
+}
+
+void ROAEngine::finishChunkIndex(QNetworkReply *_reply)
+{
+    ROAChunkIndexRequest indexRequest = indexDownloads.take(_reply);
+
+    if(_reply->error() == QNetworkReply::NoError)
+    {
+        QByteArray data = _reply->readAll();
+        QList<ROAChunk> chunks;
+
+        qint64 size = 0;
+
+        // Chunk indexes are small, they are verified in memory
+        if(QString(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex()) == indexRequest.hash && ROAChunkStore::parseIndex(data, &chunks))
+        {
+            for(int i = 0; i < chunks.size(); i++)
+            {
+                size += chunks.at(i).size;
+            }
+
+            // The index must describe the installed file, the chunks are verified again when they are read
+            if(size == QFileInfo(installationPath + indexRequest.file).size())
+            {
+                chunkStore.addFile(indexRequest.file, chunks);
+            }
+
+            return;
+        }
+    }
+
+    // The file works without its chunks, give up quietly after the last attempt
+    if(indexRequest.attempt < DOWNLOAD_MAX_ATTEMPTS)
+    {
+        indexRequest.attempt += 1;
+        indexQueue.append(indexRequest);
+    }
+}
+
+int ROAEngine::getRunningRequests() const
+{
+    return activeDownloads.size() + chunkDownloads.size() + indexDownloads.size();
+}
+
+void ROAEngine::startSegmentedDownload(QString _fileName, int _index)
+{
+    ROASegmentedDownload *segmented = new ROASegmentedDownload;
+    segmented->index = _index;
+    segmented->fileName = _fileName;
+    segmented->url = request.url();
+    segmented->hash = new QCryptographicHash(QCryptographicHash::Sha256);
+    segmented->hashed = 0;
+    segmented->running = 0;
+    segmented->waiting = 0;
+    segmented->failed = false;
+    segmented->rangesSupported = true;
+
+    // A partial file of a normal download can not be resumed from a preallocated file
+    QFile::remove(installationPath + _fileName + ".part.meta");
+
+    // Preallocate the file, the segments are written at their offsets
+    qint64 size = fileListSize.at(_index);
+
+    segmented->file = new QFile(installationPath + _fileName + ".part");
+    segmented->file->open(QIODevice::ReadWrite | QIODevice::Truncate);
+    segmented->file->resize(size);
+
+    // Split the file into ranges of the same size, the last one takes the rest
+    qint64 segmentSize = size / segmentCount;
+
+    for(int i = 0; i < segmentCount; i++)
+    {
+        ROASegment segment;
+        segment.start = i * segmentSize;
+        segment.end = (i == segmentCount - 1) ? size : (i + 1) * segmentSize;
+        segment.position = segment.start;
+        segment.attempt = 1;
+
+        segmented->segments.append(segment);
+    }
+
+    for(int i = 0; i < segmentCount; i++)
+    {
+        // The first segment takes the slot of the file, the others wait for free slots
+        if(i == 0 || getRunningRequests() < maxParallelDownloads)
+        {
+            startSegment(segmented, i);
+        }
+        else
+        {
+            ROASegmentRequest segmentRequest;
+            segmentRequest.segmented = segmented;
+            segmentRequest.segment = i;
+
+            segmentQueue.append(segmentRequest);
+            segmented->waiting += 1;
+        }
+    }
+}
+
+void ROAEngine::startSegment(ROASegmentedDownload *_segmented, int _segment)
+{
+    const ROASegment &segment = _segmented->segments.at(_segment);
+
+    ROADownload download;
+    download.index = _segmented->index;
+    download.fileName = _segmented->fileName;
+    download.attempt = segment.attempt;
+    download.file = _segmented->file;
+    download.hash = _segmented->hash;
+    download.offset = segment.position;
+    download.headersHandled = false;
+    download.accepted = false;
+    download.segmented = _segmented;
+    download.segment = _segment;
+    download.type = ROADownloadFile;
+    download.decompressor = 0;
+    download.extractor = 0;
+
+    // Request the missing part of the segment only
+    QNetworkRequest segmentRequest = request;
+    segmentRequest.setUrl(_segmented->url);
+    segmentRequest.setRawHeader("Range", "bytes=" + QByteArray::number(segment.position) + "-" + QByteArray::number(segment.end - 1));
+
+    QNetworkReply *reply = manager.get(segmentRequest);
+
+    reply->setReadBufferSize(DOWNLOAD_READ_BUFFER_SIZE);
+
+    connect(reply, SIGNAL(readyRead()), this, SLOT(slot_downloadReadyRead()));
+
+    traceRequest(reply);
+
+    activeDownloads.insert(reply, download);
+
+    _segmented->running += 1;
+}
+
+void ROAEngine::writeSegmentData(QNetworkReply *_reply, ROADownload &_download)
+{
+    ROASegmentedDownload *segmented = _download.segmented;
+    ROASegment &segment = segmented->segments[_download.segment];
+
+    // Only partial content of the requested range can be written at the offset
+    if(!_download.headersHandled)
+    {
+        _download.headersHandled = true;
+
+        int status = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+        _download.accepted = status == 206 && checkContentRange(_reply, segment);
+
+        // The server ignores or breaks ranges, the file is downloaded in one stream
+        if(status == 200 || (status == 206 && !_download.accepted))
+        {
+            segmented->rangesSupported = false;
+            cancelSegments(segmented);
+            return;
+        }
+    }
+
+    while(_reply->bytesAvailable() > 0)
+    {
+        qint64 size = _reply->read(downloadBuffer.data(), downloadBuffer.size());
+
+        if(size <= 0)
+        {
+            break;
+        }
+
+        progress.addReceived(segmented->fileName, size);
+
+        // Drop error bodies and anything beyond the segment
+        size = qMin(size, segment.end - segment.position);
+
+        if(!_download.accepted || size <= 0)
+        {
+            continue;
+        }
+
+        segmented->file->seek(segment.position);
+        segmented->file->write(downloadBuffer.constData(), size);
+
+        // Data at the front of the hash is hashed right away, no need to read it again
+        if(segment.position == segmented->hashed)
+        {
+            segmented->hash->addData(downloadBuffer.constData(), size);
+            segmented->hashed += size;
+        }
+
+        segment.position += size;
+    }
+
+    updateSegmentedHash(segmented);
+}
+
+bool ROAEngine::checkContentRange(QNetworkReply *_reply, const ROASegment &_segment)
+{
+    // Content-Range: bytes <first>-<last>/<size>
+    QByteArray range = _reply->rawHeader("Content-Range").trimmed();
+
+    if(!range.startsWith("bytes "))
+    {
+        return false;
+    }
+
+    range = range.mid(6);
+    range = range.left(range.indexOf('/'));
+
+    int separator = range.indexOf('-');
+
+    if(separator < 0)
+    {
+        return false;
+    }
+
+    bool firstOk = false;
+    bool lastOk = false;
+
+    qint64 first = range.left(separator).toLongLong(&firstOk);
+    qint64 last = range.mid(separator + 1).toLongLong(&lastOk);
+
+    // A shorter range is fine, the rest is requested again
+    return firstOk && lastOk && first == _segment.position && last >= first && last < _segment.end;
+}
+
+void ROAEngine::cancelSegments(ROASegmentedDownload *_segmented)
+{
+    _segmented->failed = true;
+
+    // Waiting segments are not started anymore
+    for(int i = segmentQueue.size() - 1; i >= 0; i--)
+    {
+        if(segmentQueue.at(i).segmented == _segmented)
+        {
+            segmentQueue.removeAt(i);
+            _segmented->waiting -= 1;
+        }
+    }
+
+    /* Running segments are aborted once the current slot returned
+     * abort() emits finished synchronously, which would delete the download while its data is handled
+     */
+    QHash<QNetworkReply*, ROADownload>::const_iterator i;
+
+    for(i = activeDownloads.constBegin(); i != activeDownloads.constEnd(); ++i)
+    {
+        if(i.value().segmented == _segmented)
+        {
+            QMetaObject::invokeMethod(i.key(), "abort", Qt::QueuedConnection);
+        }
+    }
+}
+
+void ROAEngine::updateSegmentedHash(ROASegmentedDownload *_segmented)
+{
+    for(int i = 0; i < _segmented->segments.size(); i++)
+    {
+        const ROASegment &segment = _segmented->segments.at(i);
+
+        // Skip segments which are already hashed
+        if(segment.end <= _segmented->hashed)
+        {
+            continue;
+        }
+
+        // Hash the data the next segment already wrote to the disk
+        if(segment.position > _segmented->hashed)
+        {
+            _segmented->file->seek(_segmented->hashed);
+
+            while(_segmented->hashed < segment.position)
+            {
+                qint64 size = _segmented->file->read(downloadBuffer.data(), qMin<qint64>(downloadBuffer.size(), segment.position - _segmented->hashed));
+
+                if(size <= 0)
+                {
+                    return;
+                }
+
+                _segmented->hash->addData(downloadBuffer.constData(), size);
+                _segmented->hashed += size;
+            }
+        }
+
+        // The rest of the file depends on this segment
+        if(segment.position < segment.end)
+        {
+            return;
+        }
+    }
+}
+
+void ROAEngine::finishSegment(QNetworkReply *_reply, ROADownload &_download)
+{
+    ROASegmentedDownload *segmented = _download.segmented;
+    ROASegment &segment = segmented->segments[_download.segment];
+
+    writeSegmentData(_reply, _download);
+
+    segmented->running -= 1;
+
+    // Request the missing part of an incomplete segment again
+    if(segment.position < segment.end && segmented->rangesSupported && !segmented->failed)
+    {
+        if(segment.attempt < DOWNLOAD_MAX_ATTEMPTS)
+        {
+            segment.attempt += 1;
+            startSegment(segmented, _download.segment);
+        }
+        else
+        {
+            segmented->failed = true;
+        }
+    }
+    else if(segment.position < segment.end)
+    {
+        segmented->failed = true;
+    }
+
+    // Wait for the other segments
+    if(segmented->running > 0 || segmented->waiting > 0)
+    {
+        return;
+    }
+
+    completeSegmentedDownload(segmented);
+}
+
+void ROAEngine::completeSegmentedDownload(ROASegmentedDownload *_segmented)
+{
+    bool committed = false;
+
+    if(!_segmented->failed)
+    {
+        _segmented->file->setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+        _segmented->file->close();
+
+        // All data is hashed in order, compare with the file list
+        if(_segmented->hashed == _segmented->file->size() && QString(_segmented->hash->result().toHex()) == fileListMD5.at(_segmented->index))
+        {
+            committed = installDownloadedFile(_segmented->fileName, fileListMD5.at(_segmented->index));
+        }
+    }
+    else
+    {
+        _segmented->file->close();
+    }
+
+    if(!committed)
+    {
+        QFile::remove(_segmented->file->fileName());
+
+        // Fall back to a single stream if the server does not support ranges or the data was broken
+        request.setUrl(_segmented->url);
+        startDownload(_segmented->fileName, _segmented->index, _segmented->rangesSupported ? DOWNLOAD_MAX_ATTEMPTS : 1);
+    }
+
+    delete _segmented->file;
+    delete _segmented->hash;
+    delete _segmented;
+}
+
+
+void ROAEngine::setPhase(QString _phase)
+{
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->phaseChanged(_phase);
+    }
+}
+
+void ROAEngine::stopRun(QString _message)
+{
+    progressTimer.stop();
+    metrics.endAll();
+
+    delete trace;
+    trace = 0;
+
+    waitingRequests.clear();
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->error(_message);
+        listener->finished(false, QStringList());
+    }
+
+    // Both are queued, the message arrives first
+    emit errorOccurred(_message);
+    emit finished(false, QStringList());
+}
+
+void ROAEngine::startFile(QString _file)
+{
+    fileStartTimes.insert(_file, runTimer.elapsed());
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->fileStarted(_file);
+    }
+}
+
+void ROAEngine::finishFile(QString _file, bool _success)
+{
+    qint64 duration = runTimer.elapsed() - fileStartTimes.take(_file);
+    qint64 bytes = progress.getReceived(_file);
+
+    progress.finishFile(_file);
+
+    metrics.addBytes("download", bytes);
+    metrics.addFiles("download", _success ? 1 : 0);
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->fileFinished(_file, _success, bytes, duration);
+    }
+}
+
+qint64 ROAEngine::traceTime()
+{
+    return trace ? trace->now() : 0;
+}
+
+void ROAEngine::traceSpan(QString _name, qint64 _start, QString _file)
+{
+    if(trace)
+    {
+        trace->complete(_name, _start, _file);
+    }
+}
+
+void ROAEngine::traceRequest(QNetworkReply *_reply)
+{
+    if(!trace)
+    {
+        return;
+    }
+
+    trace->asyncBegin("request", _reply, _reply->url().path());
+    trace->asyncBegin("first byte", _reply, _reply->url().path());
+
+    waitingRequests.insert(_reply);
+
+    connect(_reply, SIGNAL(metaDataChanged()), this, SLOT(slot_traceFirstByte()));
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Slots                                                                   */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAEngine::slot_downloadFinished(QNetworkReply *reply)
+{
+    requestCount += 1;
+
+    if(trace)
+    {
+        // Requests without a response end both spans
+        if(waitingRequests.remove(reply))
+        {
+            trace->asyncEnd("first byte", reply);
+        }
+
+        trace->asyncEnd("request", reply);
+    }
+
+    // Writing the rest of the data, verifying and moving the file into place
+    QElapsedTimer writeTimer;
+    writeTimer.start();
+
+    qint64 commitStart = traceTime();
+
+    if(reply->attribute(QNetworkRequest::ConnectionEncryptedAttribute).toBool())
+    {
+        encryptedResponses += 1;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    if(reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool())
+    {
+        http2Responses += 1;
+    }
+#endif
+
+    // Chunks of files assembled from a chunk index
+    if(chunkDownloads.contains(reply))
+    {
+        metrics.addBytes("write", reply->bytesAvailable());
+
+        QString chunk = reply->url().path();
+
+        finishChunk(reply);
+        reply->deleteLater();
+
+        metrics.addTime("write", writeTimer.nsecsElapsed());
+        traceSpan("commit", commitStart, chunk);
+
+        getNextFile();
+        return;
+    }
+
+    // Chunk indexes of installed files
+    if(indexDownloads.contains(reply))
+    {
+        finishChunkIndex(reply);
+        reply->deleteLater();
+
+        getNextFile();
+        return;
+    }
+
+    // Ignore replies we did not request
+    if(!activeDownloads.contains(reply))
+    {
+        reply->deleteLater();
+        return;
+    }
+
+    ROADownload download = activeDownloads.take(reply);
+
+    metrics.addBytes("write", reply->bytesAvailable());
+
+    // Bundles are extracted while downloading
+    if(download.extractor)
+    {
+        finishBundle(reply, download);
+        reply->deleteLater();
+
+        metrics.addTime("write", writeTimer.nsecsElapsed());
+        traceSpan("commit", commitStart, download.fileName);
+
+        getNextFile();
+        return;
+    }
+
+    // Segments of large files are verified when the last one is done
+    if(download.segmented)
+    {
+        finishSegment(reply, download);
+        reply->deleteLater();
+
+        metrics.addTime("write", writeTimer.nsecsElapsed());
+        traceSpan("commit", commitStart, download.fileName);
+
+        getNextFile();
+        return;
+    }
+
+    // Write the data left in the reply
+    writeDownloadData(reply, download);
+
+    // Set exe permissions
+    download.file->setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+
+    // Close the file
+    download.file->close();
+
+    // Verify the data and move it into place
+    bool committed = commitDownload(reply, download);
+
+    delete download.file;
+    delete download.hash;
+    delete download.decompressor;
+
+    // The reply is no longer needed
+    reply->deleteLater();
+
+    metrics.addTime("write", writeTimer.nsecsElapsed());
+    traceSpan("commit", commitStart, download.fileName);
+
+    // Apply patches, on any problem the whole file is downloaded instead
+    if(download.type == ROADownloadPatch)
+    {
+        if(!committed || !applyPatch(download.index))
+        {
+            // The full download does not resume the data of the patch
+            QFile::remove(installationPath + download.fileName);
+            QFile::remove(installationPath + download.fileName + ".part");
+            QFile::remove(installationPath + download.fileName + ".part.meta");
+            startFullDownload(download.index);
+
+            return;
+        }
+
+        getNextFile();
+        return;
+    }
+
+    // Assemble files from their chunk index, on any problem the whole file is downloaded instead
+    if(download.type == ROADownloadChunkIndex)
+    {
+        if(!committed || !assembleChunkedFile(download.index))
+        {
+            // The full download does not resume the data of the chunk index
+            QFile::remove(installationPath + download.fileName);
+            QFile::remove(installationPath + download.fileName + ".part");
+            QFile::remove(installationPath + download.fileName + ".part.meta");
+            startFullDownload(download.index);
+
+            return;
+        }
+
+        getNextFile();
+        return;
+    }
+
+    if(!committed)
+    {
+        if(download.attempt < DOWNLOAD_MAX_ATTEMPTS)
+        {
+            // Request the file again, the download slot is reused
+            request.setUrl(reply->request().url());
+            startDownload(download.fileName, download.index, download.attempt + 1);
+
+            return;
+        }
+        else if(download.index < 0)
+        {
+            // The file list of the last run may be outdated, never verify against it
+            stopRun(tr("Could not download the file list: ") + reply->errorString());
+            return;
+        }
+        else
+        {
+            failedFiles.append(download.fileName);
+            finishFile(download.fileName, false);
+        }
+    }
+
+    // If phase 0 take future steps
+    switch(downloadPhase)
+    {
+        case 0:
+            prepareDownload();
+            downloadPhase = 1;
+            break;
+        case 1:
+            getNextFile();
+            break;
+    }
+}
+
+void ROAEngine::slot_downloadReadyRead()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+    if(reply && activeDownloads.contains(reply))
+    {
+        // Only the handling of the data counts, not the wait for the network
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+
+        qint64 writeStart = traceTime();
+
+        metrics.addBytes("write", reply->bytesAvailable());
+
+        writeDownloadData(reply, activeDownloads[reply]);
+
+        metrics.addTime("write", writeTimer.nsecsElapsed());
+        traceSpan("write", writeStart, activeDownloads.value(reply).fileName);
+    }
+}
+
+void ROAEngine::slot_verifyResultReady(int _index)
+{
+    ROAVerifyJob job = verifyWatcher.resultAt(_index);
+
+    hashedBytes += job.bytes;
+
+    metrics.addBytes("verify", job.bytes);
+    metrics.addFiles("verify", 1);
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->fileVerified(job.file, job.valid, job.bytes);
+    }
+
+    if(!job.chunkIndex.isEmpty())
+    {
+        chunkIndexes.insert(job.file, job.chunkIndex);
+    }
+
+    // Queue broken or missing files and start downloading them right away
+    if(job.valid)
+    {
+        if(job.cacheable)
+        {
+            job.status.hash = job.hash;
+            hashCache.insert(job.file, job.status);
+        }
+        else
+        {
+            hashCache.remove(job.file);
+        }
+
+        // Files installed in full or by older installers provide their chunks to later releases
+        queueChunkIndex(job.file);
+    }
+    else
+    {
+        hashCache.remove(job.file);
+
+        progress.addFile(job.file, job.size);
+
+        // Files of bundles wait for the end of the verification, then we know if the bundle is worth it
+        foreach(QString directory, bundles)
+        {
+            if(job.file.startsWith(directory + "/"))
+            {
+                bundleMissing[directory].append(job);
+                return;
+            }
+        }
+
+        queueFile(job);
+        getNextFile();
+    }
+}
+
+void ROAEngine::slot_verifyFinished()
+{
+    hashingTime = verifyTimer.nsecsElapsed();
+    verifyRunning = false;
+    verifyJobs.clear();
+
+    // The hash throughput is reported with the verify phase of the metrics
+    metrics.end("verify");
+
+    setPhase("download");
+
+    // Download bundles for directories with many missing files, else the files on their own
+    foreach(QString directory, bundleMissing.keys())
+    {
+        if(bundleMissing.value(directory).size() >= bundleThreshold)
+        {
+            startBundleDownload(directory);
+        }
+        else
+        {
+            foreach(const ROAVerifyJob &job, bundleMissing.take(directory))
+            {
+                queueFile(job);
+            }
+        }
+    }
+
+    // Finish if the downloads are already done
+    getNextFile();
+}
+
+void ROAEngine::slot_encrypted(QNetworkReply* reply)
+{
+    // Only emitted for the handshake, requests on a reused connection do not trigger it
+    tlsHandshakes += 1;
+
+    if(trace)
+    {
+        trace->instant("tls handshake", reply->url().path());
+    }
+}
+
+void ROAEngine::slot_traceFirstByte()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+    // Redirects and trailers change the meta data again
+    if(trace && reply && waitingRequests.remove(reply))
+    {
+        trace->asyncEnd("first byte", reply);
+    }
+}
+
+void ROAEngine::slot_updateProgress()
+{
+    progress.sample();
+
+    QString text = tr("Currently downloading: ") + currentFile;
+
+    text += tr(" - %1 of %2 MB, %3 MB/s")
+            .arg(progress.getDone() / (1024 * 1024))
+            .arg(progress.getTotal() / (1024 * 1024))
+            .arg(progress.getThroughput() / (1024 * 1024), 0, 'f', 1);
+
+    qint64 remaining = progress.getRemainingTime();
+
+    if(remaining >= 0)
+    {
+        text += tr(", %1:%2 left").arg(remaining / 60).arg(remaining % 60, 2, 10, QChar('0'));
+    }
+
+    foreach(ROAEngineListener *listener, listeners)
+    {
+        listener->progress(progress.getDone(), progress.getTotal(), progress.getThroughput(), remaining);
+    }
+
+    emit progressChanged(progress.getPercent(), text);
+}
+
+void ROAEngine::slot_getSSLError(QNetworkReply* reply, const QList<QSslError> &errors)
+{
+    QSslError sslError = errors.first();
+
+    if(sslError.error() == 11 )
+    {
+        //reply->ignoreSslErrors();
+        foreach(ROAEngineListener *listener, listeners)
+        {
+            listener->error(reply->errorString());
+        }
+
+        emit errorOccurred(reply->errorString());
+    }
+}
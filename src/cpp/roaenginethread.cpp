@@ -0,0 +1,90 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Thread running the engine for a frontend
+ *
+ * \file    	roaenginethread.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roaenginethread.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAEngineThread::ROAEngineThread(QObject *parent) :
+    QThread(parent)
+{
+    engine = new ROAEngine();
+    engine->moveToThread(this);
+
+    // Names the track of the engine in traces
+    setObjectName("engine");
+
+    connect(this, SIGNAL(finished()), engine, SLOT(deleteLater()));
+}
+
+ROAEngineThread::~ROAEngineThread()
+{
+    // Let the engine finish its events, it is deleted on its thread
+    quit();
+    wait();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+ROAEngine *ROAEngineThread::getEngine() const
+{
+    return engine;
+}
+
+void ROAEngineThread::startFor(QObject *_frontend)
+{
+    connect(_frontend, SIGNAL(startEngine(QString, QString, bool)), engine, SLOT(start(QString, QString, bool)));
+    connect(_frontend, SIGNAL(startUninstall(QString)), engine, SLOT(uninstall(QString)));
+    connect(engine, SIGNAL(progressChanged(int, QString)), _frontend, SLOT(slot_engineProgress(int, QString)));
+    connect(engine, SIGNAL(errorOccurred(QString)), _frontend, SLOT(slot_engineError(QString)));
+    connect(engine, SIGNAL(finished(bool, QStringList)), _frontend, SLOT(slot_engineFinished(bool, QStringList)));
+    connect(engine, SIGNAL(uninstallFinished(bool)), _frontend, SLOT(slot_uninstallFinished(bool)));
+
+    start();
+}
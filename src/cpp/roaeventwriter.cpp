@@ -0,0 +1,228 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Machine readable event stream of the engine
+ *
+ * \file    	roaeventwriter.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roaeventwriter.h"
+
+#include <stdio.h>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAEventWriter::ROAEventWriter(QString _target) :
+    lastProgress(-1),
+    verifiedFiles(0),
+    validFiles(0),
+    hashedBytes(0),
+    downloadedFiles(0),
+    failedFiles(0),
+    receivedBytes(0)
+{
+    if(_target == "-")
+    {
+        file.open(stdout, QIODevice::WriteOnly);
+    }
+    else
+    {
+        file.setFileName(_target);
+        file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    timer.start();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+bool ROAEventWriter::isOpen() const
+{
+    return file.isOpen();
+}
+
+void ROAEventWriter::phaseChanged(QString _phase)
+{
+    QJsonObject data;
+    data.insert("phase", _phase);
+
+    write("phase", data);
+}
+
+void ROAEventWriter::fileVerified(QString _file, bool _valid, qint64 _hashedBytes)
+{
+    verifiedFiles += 1;
+    validFiles += _valid ? 1 : 0;
+    hashedBytes += _hashedBytes;
+
+    QJsonObject data;
+    data.insert("file", _file);
+    data.insert("valid", _valid);
+    data.insert("hashedBytes", (double)_hashedBytes);
+
+    write("verified", data);
+}
+
+void ROAEventWriter::fileStarted(QString _file)
+{
+    QJsonObject data;
+    data.insert("file", _file);
+
+    write("fileStarted", data);
+}
+
+void ROAEventWriter::fileFinished(QString _file, bool _success, qint64 _bytes, qint64 _duration)
+{
+    if(_success)
+    {
+        downloadedFiles += 1;
+    }
+    else
+    {
+        failedFiles += 1;
+    }
+
+    receivedBytes += _bytes;
+
+    QJsonObject data;
+    data.insert("file", _file);
+    data.insert("success", _success);
+    data.insert("bytes", (double)_bytes);
+    data.insert("duration", (double)_duration);
+
+    write("fileFinished", data);
+}
+
+void ROAEventWriter::progress(qint64 _done, qint64 _total, double _throughput, qint64 _remaining)
+{
+    // The engine reports ten times per second, once per second is enough for aggregating
+    qint64 now = timer.elapsed();
+
+    if(lastProgress >= 0 && now - lastProgress < 1000)
+    {
+        return;
+    }
+
+    lastProgress = now;
+
+    QJsonObject data;
+    data.insert("done", (double)_done);
+    data.insert("total", (double)_total);
+    data.insert("throughput", _throughput);
+    data.insert("remaining", (double)_remaining);
+
+    write("progress", data);
+}
+
+void ROAEventWriter::error(QString _message)
+{
+    QJsonObject data;
+    data.insert("message", _message);
+
+    write("error", data);
+}
+
+void ROAEventWriter::metricsReported(const QMap<QString, double> &_metrics)
+{
+    QJsonObject data;
+
+    QMap<QString, double>::const_iterator i;
+
+    for(i = _metrics.constBegin(); i != _metrics.constEnd(); ++i)
+    {
+        data.insert(i.key(), i.value());
+    }
+
+    write("metrics", data);
+}
+
+void ROAEventWriter::finished(bool _success, const QStringList &_failedFiles)
+{
+    qint64 duration = timer.elapsed();
+
+    QJsonObject data;
+    data.insert("success", _success);
+    data.insert("failedFiles", QJsonArray::fromStringList(_failedFiles));
+    data.insert("verifiedFiles", verifiedFiles);
+    data.insert("validFiles", validFiles);
+    data.insert("hashedBytes", (double)hashedBytes);
+    data.insert("downloadedFiles", downloadedFiles);
+    data.insert("failedDownloads", failedFiles);
+    data.insert("receivedBytes", (double)receivedBytes);
+    data.insert("duration", (double)duration);
+    data.insert("throughput", (duration > 0) ? receivedBytes * 1000.0 / duration : 0.0);
+
+    write("summary", data);
+}
+
+void ROAEventWriter::uninstallFinished(bool _success)
+{
+    QJsonObject data;
+    data.insert("success", _success);
+
+    write("uninstall", data);
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAEventWriter::write(QString _event, QJsonObject _data)
+{
+    if(!file.isOpen())
+    {
+        return;
+    }
+
+    _data.insert("event", _event);
+    _data.insert("time", (double)timer.elapsed());
+
+    file.write(QJsonDocument(_data).toJson(QJsonDocument::Compact));
+    file.write("\n");
+
+    // Readers follow the stream live
+    file.flush();
+}
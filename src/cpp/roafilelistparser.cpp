@@ -0,0 +1,178 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Reads the file list without copying it
+ *
+ * \file    	roafilelistparser.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roafilelistparser.h"
+
+#include <string.h>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constants                                                               */
+/*                                                                            */
+/******************************************************************************/
+
+/**
+ * \brief Maximal amount of fields of a line
+ */
+static const int FILE_LIST_MAX_FIELDS = 6;
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAFileListParser::ROAFileListParser(const char *_data, qint64 _size) :
+    position(_data),
+    end(_data + _size)
+{
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+bool ROAFileListParser::next(ROAFileListEntry *_entry)
+{
+    while(position < end)
+    {
+        const char *lineEnd = static_cast<const char*>(memchr(position, '\n', end - position));
+
+        if(!lineEnd)
+        {
+            lineEnd = end;
+        }
+
+        const char *line = position;
+        const char *lineStop = lineEnd;
+
+        position = (lineEnd < end) ? lineEnd + 1 : end;
+
+        // Files written on windows
+        if(lineStop > line && *(lineStop - 1) == '\r')
+        {
+            lineStop -= 1;
+        }
+
+        // One more than allowed, to detect lines with too many fields
+        ROAByteView fields[FILE_LIST_MAX_FIELDS + 1];
+        int count = 0;
+
+        const char *field = line;
+
+        while(count <= FILE_LIST_MAX_FIELDS)
+        {
+            const char *separator = static_cast<const char*>(memchr(field, ';', lineStop - field));
+            const char *fieldEnd = separator ? separator : lineStop;
+
+            fields[count].data = field;
+            fields[count].size = fieldEnd - field;
+            count += 1;
+
+            if(!separator)
+            {
+                break;
+            }
+
+            field = separator + 1;
+        }
+
+        // Same rules as the line based reading before, a line without separator is no entry
+        if(count < 2 || count > FILE_LIST_MAX_FIELDS)
+        {
+            continue;
+        }
+
+        for(int i = count; i < FILE_LIST_MAX_FIELDS; i++)
+        {
+            fields[i].data = lineStop;
+            fields[i].size = 0;
+        }
+
+        _entry->bundle = (count == 2 && fields[0].size == 6 && memcmp(fields[0].data, "bundle", 6) == 0);
+
+        if(_entry->bundle)
+        {
+            _entry->file = fields[1];
+            _entry->hash = fields[2];
+        }
+        else
+        {
+            _entry->file = fields[0];
+            _entry->hash = fields[1];
+        }
+
+        _entry->size = fields[2];
+        _entry->patches = fields[3];
+        _entry->compression = fields[4];
+        _entry->chunks = fields[5];
+
+        return true;
+    }
+
+    return false;
+}
+
+qint64 ROAFileListParser::toNumber(ROAByteView _view)
+{
+    if(_view.size == 0)
+    {
+        return -1;
+    }
+
+    qint64 value = 0;
+
+    for(int i = 0; i < _view.size; i++)
+    {
+        char digit = _view.data[i];
+
+        if(digit < '0' || digit > '9')
+        {
+            return -1;
+        }
+
+        value = value * 10 + (digit - '0');
+    }
+
+    return value;
+}
@@ -0,0 +1,184 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Cache of verified file hashes keyed by the file status
+ *
+ * \file    	roahashcache.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roahashcache.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAHashCache::ROAHashCache()
+{
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+bool ROAHashCache::load(QString _file)
+{
+    fileName = _file;
+    entries.clear();
+
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QTextStream in(&file);
+
+    // Format: path;size;modified;inode;hash
+    while(!in.atEnd())
+    {
+        QStringList tmp = in.readLine().split(";");
+
+        if(tmp.size() == 5)
+        {
+            ROAHashCacheEntry entry;
+            entry.size = tmp.at(1).toLongLong();
+            entry.modified = tmp.at(2).toLongLong();
+            entry.inode = tmp.at(3).toULongLong();
+            entry.hash = tmp.at(4);
+
+            entries.insert(tmp.at(0), entry);
+        }
+    }
+
+    file.close();
+
+    return true;
+}
+
+bool ROAHashCache::save()
+{
+    if(fileName.isEmpty())
+    {
+        return false;
+    }
+
+    // Write to a temporary file first, an interrupted write must not leave a broken cache
+    QFile file(fileName + ".part");
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    QHash<QString, ROAHashCacheEntry>::const_iterator i;
+
+    for(i = entries.constBegin(); i != entries.constEnd(); ++i)
+    {
+        out << i.key() << ";" << i.value().size << ";" << i.value().modified << ";" << i.value().inode << ";" << i.value().hash << "\n";
+    }
+
+    out.flush();
+    file.close();
+
+    QFile::remove(fileName);
+
+    return QFile::rename(fileName + ".part", fileName);
+}
+
+QHash<QString, ROAHashCacheEntry> ROAHashCache::getEntries() const
+{
+    return entries;
+}
+
+void ROAHashCache::insert(QString _path, const ROAHashCacheEntry &_entry)
+{
+    entries.insert(_path, _entry);
+}
+
+void ROAHashCache::remove(QString _path)
+{
+    entries.remove(_path);
+}
+
+bool ROAHashCache::readStatus(QString _file, ROAHashCacheEntry *_entry)
+{
+    QFileInfo info(_file);
+
+    if(!info.exists() || !info.isFile())
+    {
+        return false;
+    }
+
+    _entry->size = info.size();
+    _entry->modified = info.lastModified().toMSecsSinceEpoch();
+    _entry->inode = 0;
+
+#ifdef Q_OS_UNIX
+    // A replaced file gets a new inode even if size and time are restored
+    struct stat status;
+
+    if(::stat(QFile::encodeName(_file).constData(), &status) == 0)
+    {
+        _entry->inode = status.st_ino;
+    }
+#endif
+
+    return true;
+}
+
+bool ROAHashCache::isUnchanged(const ROAHashCacheEntry &_before, const ROAHashCacheEntry &_after)
+{
+    return _before.size == _after.size
+            && _before.modified == _after.modified
+            && _before.inode == _after.inode;
+}
+
+bool ROAHashCache::isValid(const ROAHashCacheEntry &_cached, const ROAHashCacheEntry &_current, QString _hash)
+{
+    return isUnchanged(_cached, _current) && _cached.hash == _hash;
+}
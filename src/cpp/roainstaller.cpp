@@ -49,8 +49,7 @@
 ROAInstaller::ROAInstaller(QObject *parent) :
     QObject(parent)
 {
-    // Set download phase for later
-    downloadPhase = 0;
+    deepVerify = false;
 
     // Create settings object with old name
     userSettings = new QSettings(QSettings::IniFormat, QSettings::UserScope, "Quantum Bytes GmbH", "Relics of Annorath");
@@ -72,10 +71,10 @@ ROAInstaller::ROAInstaller(QObject *parent) :
         cleanupObsoletFiles();
 
         // Remove old dirs
-        removeDirWithContent(installPathOld + "lib");
-        removeDirWithContent(installPathOld + "imageformats");
-        removeDirWithContent(installPathOld + "sounds");
-        removeDirWithContent(installPathOld + "downloads");
+        ROAEngine::removeDirWithContent(installPathOld + "lib");
+        ROAEngine::removeDirWithContent(installPathOld + "imageformats");
+        ROAEngine::removeDirWithContent(installPathOld + "sounds");
+        ROAEngine::removeDirWithContent(installPathOld + "downloads");
 
         // Rename old dirs
         QDir dir;
@@ -114,6 +113,10 @@ ROAInstaller::ROAInstaller(QObject *parent) :
 
         blockMode = false;
     }
+
+    // The engine runs on its own thread, all communication is queued
+    engine = engineThread.getEngine();
+    engineThread.startFor(this);
 }
 
 ROAInstaller::~ROAInstaller()
@@ -159,11 +162,8 @@ void ROAInstaller::update()
         mainWidget->setCustomContentId(4);
         mainWidget->show();
 
-        // Check for needed dirs and create them if needed
-        checkDirectories();
-
-        // Get file list for verification, after this point everything is handled with slots
-        getRemoteFileList();
+        // Verify and download on the engine thread, after this point everything is handled with slots
+        emit startEngine(installationPath, installationMode, deepVerify);
     }
     else
     {
@@ -178,11 +178,8 @@ void ROAInstaller::verify()
         // Set installation mode
         installationMode = "verify";
 
-        // Check for needed dirs and create them if needed
-        checkDirectories();
-
-        // Get file list for verification, after this point everything is handled with slots
-        getRemoteFileList();
+        // Verify and download on the engine thread, after this point everything is handled with slots
+        emit startEngine(installationPath, installationMode, deepVerify);
     }
     else
     {
@@ -203,17 +200,8 @@ void ROAInstaller::repair()
     // Installpath is fine
     if(!blockMode)
     {
-        // Remove game content
-        if(removeDirWithContent(installationPath + "game"))
-        {
-            // Verify
-            checkDirectories();
-            getRemoteFileList();
-        }
-        else
-        {
-            QMessageBox::warning(NULL,tr("Repair failed"), tr("Please remove the \"game\" folder under ") + installationPath + tr("!"));
-        }
+        // Remove game content and verify on the engine thread
+        emit startEngine(installationPath, installationMode, deepVerify);
     }
     else
     {
@@ -251,17 +239,8 @@ void ROAInstaller::repair()
             // Set installation path
             userSettings->value("installLocation", installationPath);
 
-            // Remove game content
-            if(removeDirWithContent(installationPath + "game"))
-            {
-                // Verify
-                checkDirectories();
-                getRemoteFileList();
-            }
-            else
-            {
-                QMessageBox::warning(NULL,tr("Repair failed"), tr("Please remove the \"game\" folder under ") + installationPath + tr("!"));
-            }
+            // Remove game content and verify on the engine thread
+            emit startEngine(installationPath, installationMode, deepVerify);
         }
         else
         {
@@ -270,6 +249,31 @@ void ROAInstaller::repair()
     }
 }
 
+void ROAInstaller::setDeepVerify(bool _deep)
+{
+    deepVerify = _deep;
+}
+
+void ROAInstaller::addListener(ROAEngineListener *_listener)
+{
+    engine->addListener(_listener);
+}
+
+void ROAInstaller::setMetricsFile(QString _fileName)
+{
+    engine->setMetricsFile(_fileName);
+}
+
+void ROAInstaller::setTraceFile(QString _fileName)
+{
+    engine->setTraceFile(_fileName);
+}
+
+void ROAInstaller::setBaseUrl(QString _url)
+{
+    engine->setBaseUrl(_url);
+}
+
 void ROAInstaller::uninstall()
 {
     if(!blockMode)
@@ -277,23 +281,20 @@ void ROAInstaller::uninstall()
         // Check for user confirmation
         if(QMessageBox::Cancel == QMessageBox::warning(NULL,tr("Uninstallation"), tr("All files in the directory ") + installationPath + tr(" are going to be deleted!"), QMessageBox::Ok, QMessageBox::Cancel))
         {
-            QApplication::quit();
+            // The event loop is not running yet
+            QTimer::singleShot(0, qApp, SLOT(quit()));
         }
         else
         {
-            if(removeDirWithContent(installationPath ))
-            {
-                QMessageBox::information(NULL,tr("Client uninstalled successfully"), tr("Client uninstalled successfully!"));
-            }
-            else
-            {
-                QMessageBox::warning(NULL,tr("Client uninstalled failed"), tr("Client uninstalled failed! Please remove left files per hand!"));
-            }
+            // The files are removed on the engine thread, the result is shown by slot_uninstallFinished
+            emit startUninstall(installationPath);
         }
     }
     else
     {
         QMessageBox::warning(NULL,tr("Uninstallation failed"), tr("Please reinstall/repair the Relics of Annorath client!"));
+
+        QTimer::singleShot(0, qApp, SLOT(quit()));
     }
 }
 
@@ -303,37 +304,6 @@ void ROAInstaller::uninstall()
 /*                                                                            */
 /******************************************************************************/
 
-bool ROAInstaller::removeDirWithContent(QString _dir)
-{
-    // Thanks to John for the code part -> http://john.nachtimwald.com/2010/06/08/qt-remove-directory-and-its-contents/
-    bool result = true;
-
-    QDir dir(_dir);
-
-    if (dir.exists(_dir))
-    {
-        Q_FOREACH(QFileInfo info, dir.entryInfoList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst))
-        {
-            if (info.isDir())
-            {
-                result = removeDirWithContent(info.absoluteFilePath());
-            }
-            else
-            {
-                result = QFile::remove(info.absoluteFilePath());
-            }
-
-            if (!result) {
-                return result;
-            }
-        }
-
-        result = dir.rmdir(_dir);
-    }
-
-    return result;
-}
-
 void ROAInstaller::cleanupObsoletFiles()
 {
 #ifdef Q_OS_LINUX
@@ -365,67 +335,6 @@ void ROAInstaller::cleanupObsoletFiles()
 #endif
 }
 
-void ROAInstaller::checkDirectories()
-{
-    QStringList dirs;
-    dirs << installationPath + "game"
-         << installationPath + "game/bin"
-         << installationPath + "game/data"
-         << installationPath + "game/lib"
-         << installationPath + "launcher"
-         << installationPath + "launcher/platforms"
-        #ifdef Q_OS_LINUX
-         << installationPath + "launcher/bin"
-         << installationPath + "launcher/lib"
-         << installationPath + "launcher/bin/platforms"
-         << installationPath + "launcher/bin/imageformats"
-        #endif
-         << installationPath + "launcher/downloads"
-         << installationPath + "launcher/imageformats"
-         << installationPath + "launcher/sounds";
-
-    for(int i = 0; i < dirs.size(); i++)
-    {
-        QDir dir(dirs.at(i));
-        if(!dir.exists())
-            QDir().mkpath(dirs.at(i));
-    }
-}
-
-void ROAInstaller::getRemoteFileList()
-{
-    // Prepare downloading over ssl
-    certificates.append(QSslCertificate::fromPath(":/certs/class2.pem"));
-    certificates.append(QSslCertificate::fromPath(":/certs/ca.pem"));
-
-    sslConfig.defaultConfiguration();
-    sslConfig.setCaCertificates(certificates);
-
-    request.setSslConfiguration(sslConfig);
-
-    connect(&manager, SIGNAL(finished(QNetworkReply*)),this, SLOT(slot_downloadFinished(QNetworkReply*)));
-    connect(&manager, SIGNAL(sslErrors(QNetworkReply*, const QList<QSslError>&)),this, SLOT(slot_getSSLError(QNetworkReply*, const QList<QSslError>&)));
-
-#ifdef Q_OS_LINUX
-#ifdef __x86_64__
-    request.setUrl(QUrl("https://launcher.annorath-game.com/data/linux_x86_64/launcher/linux_x86_64.txt"));
-#else
-    request.setUrl(QUrl("https://launcher.annorath-game.com/data/linux_x86/launcher/linux_x86.txt"));
-#endif
-#endif
-
-#ifdef Q_OS_WIN32
-#ifdef Q_OS_WIN64
-    request.setUrl(QUrl("https://launcher.annorath-game.com/data/windows_x86_64/launcher/windows_x86_64.txt"));
-#else
-    request.setUrl(QUrl("https://launcher.annorath-game.com/data/windows_x86/launcher/windows_x86.txt"));
-#endif
-#endif
-
-    // Start download
-    manager.get(request);
-}
-
 void ROAInstaller::startInstallation()
 {
     // Set installation path
@@ -447,155 +356,8 @@ void ROAInstaller::startInstallation()
     // Get components
     componentsSelected = mainWidget->getSelectedComponents();
 
-    // Check for needed dirs and create them if needed
-    checkDirectories();
-
-    // Get file list for verification
-    getRemoteFileList();
-}
-
-void ROAInstaller::prepareDownload()
-{
-    // Open file and read it
-    QFile file(installationPath + "launcher/downloads/files.txt");
-
-    if (file.open(QIODevice::ReadOnly))
-    {
-        QTextStream in(&file);
-
-        while ( !in.atEnd() )
-        {
-            QStringList tmp = QString(in.readLine()).split(";");
-
-            // Check if we got valid input
-            if(tmp.size() == 2)
-            {
-                // Check for correct files, do not download not needed data
-                if(!checkFileWithHash(tmp.at(0), tmp.at(1)))
-                {
-                    // Save values
-                    fileList.append(tmp.at(0));
-                    fileListMD5.append(tmp.at(1));
-                }
-            }
-        }
-    }
-
-    // Close file
-    file.close();
-
-    // Calculate remaing files
-    filesLeft = fileList.size();
-
-    // Get the next file
-    getNextFile();
-}
-
-bool ROAInstaller::checkFileWithHash(QString _file, QString _hash)
-{
-    QFile file(installationPath + _file);
-
-    if(file.open(QIODevice::ReadOnly))
-    {
-        // Get bytes
-        QByteArray fileData = file.readAll();
-
-        // Get hash
-        QByteArray hash = QCryptographicHash::hash(fileData, QCryptographicHash::Sha256);
-
-        // Compare
-        if(QString(hash.toHex()) == _hash)
-        {
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
-    else
-    {
-        return false;
-    }
-}
-
-void ROAInstaller::getNextFile()
-{
-    if(filesLeft > 0)
-    {
-        // Set URL and start download
-#ifdef Q_OS_LINUX
-#ifdef __x86_64__
-        request.setUrl(QUrl("https://launcher.annorath-game.com/data/linux_x86_64/" + fileList.at(filesLeft-1)));
-#else
-        request.setUrl(QUrl("https://launcher.annorath-game.com/data/linux_x86/" + fileList.at(filesLeft-1)));
-#endif
-#endif
-
-#ifdef Q_OS_WIN32
-#ifdef Q_OS_WIN64
-        request.setUrl(QUrl("https://launcher.annorath-game.com/data/windows_x86_64/" + fileList.at(filesLeft-1)));
-#else
-        request.setUrl(QUrl("https://launcher.annorath-game.com/data/windows_x86/" + fileList.at(filesLeft-1)));
-#endif
-#endif
-        manager.get(request);
-
-
-        // Check mode
-        if(installationMode == "default" || installationMode == "update")
-        {
-            // Update status
-            mainWidget->setNewStatus(100/(fileList.size())*(fileList.size()-filesLeft));
-            mainWidget->setNewLabelText(tr("Currently downloading: ") + fileList.at(filesLeft-1));
-        }
-
-        filesLeft -= 1;
-    }
-    else
-    {
-        if(installationMode == "default")
-        {
-            // Set status to 100
-            mainWidget->setNewStatus(100);
-            mainWidget->setNewLabelText("Installing additional software...");
-
-            // Install components and creat shortcuts
-            installOptionalComponents();
-
-#ifdef Q_OS_LINUX
-            // Set last page
-            mainWidget->setCustomContentId(5);
-#endif
-        }
-        else if(installationMode == "update")
-        {
-            /// \todo relaunch the launcher
-#ifdef Q_OS_LINUX
-            createLinuxShortcut(QDir::homePath() + "/.local/share/applications/Relics of Annorath.desktop");
-            createLinuxShortcut(QDir::homePath() + "/Desktop/Relics of Annorath.desktop");
-#endif
-
-#ifdef Q_OS_WIN32
-            createWindowsShortcuts(QString(qgetenv("APPDATA")) + "/Microsoft/Windows/Start Menu/Programs/Relics of Annorath.lnk");
-            createWindowsShortcuts(QStandardPaths::standardLocations(QStandardPaths::DesktopLocation).at(0) + "/Relics of Annorath.lnk");
-#endif
-            mainWidget->setCustomContentId(5);
-        }
-        else if(installationMode == "verify")
-        {
-            QMessageBox::information(NULL,tr("Client verified successfully"), tr("Client verified successfully!"));
-        }
-        else if(installationMode == "repair")
-        {
-            QMessageBox::information(NULL,tr("Client repaired successfully"), tr("Client repaired successfully!"));
-        }
-        else
-        {
-            // Display infobox
-            QMessageBox::information(NULL,tr("Unknown installation mode"), tr("Something goes wrong, if you get this message please report it and add an step by step description!"));
-        }
-    }
+    // Verify and download on the engine thread
+    emit startEngine(installationPath, installationMode, deepVerify);
 }
 
 void ROAInstaller::installOptionalComponents()
@@ -695,70 +457,98 @@ void ROAInstaller::createWindowsShortcuts(QString _path)
 /*                                                                            */
 /******************************************************************************/
 
-void ROAInstaller::slot_downloadFinished(QNetworkReply *reply)
+void ROAInstaller::slot_engineProgress(int _percent, QString _text)
 {
-    QString fileName;
-
-    switch(downloadPhase)
+    // Only the installation and the update show the status page
+    if(installationMode == "default" || installationMode == "update")
     {
-        case 0:
-            fileName = "launcher/downloads/files.txt";
-            break;
-        case 1:
-            fileName = fileList.at(filesLeft);
-            break;
+        mainWidget->setNewStatus(_percent);
+        mainWidget->setNewLabelText(_text);
     }
+}
 
-    // Open the file to write to
-    QFile file(installationPath + fileName);
-    file.open(QIODevice::WriteOnly);
+void ROAInstaller::slot_engineError(QString _message)
+{
+    lastError = _message;
+
+    if(installationMode == "default")
+    {
+        mainWidget->setNewLabelText(_message);
+    }
+    else
+    {
+        /// \todo Add info box
+    }
+}
 
-    // Open a stream to write into the file
-    QDataStream stream(&file);
+void ROAInstaller::slot_engineFinished(bool _success, QStringList _failedFiles)
+{
+    // The run was stopped, e.g. the file list could not be downloaded
+    if(!_success)
+    {
+        QString title = (installationMode == "repair") ? tr("Repair failed") : tr("Installation failed");
 
-    // Get the size of the torrent
-    int size = reply->size();
+        QMessageBox::warning(NULL, title, lastError);
+        return;
+    }
 
-    // Get the data of the torrent
-    QByteArray temp = reply->readAll();
+    if(!_failedFiles.isEmpty())
+    {
+        QMessageBox::warning(NULL,tr("Download failed"), tr("The following files could not be downloaded:\n\n") + _failedFiles.join("\n"));
+    }
 
-    // Write the file
-    stream.writeRawData(temp, size);
+    if(installationMode == "default")
+    {
+        // Set status to 100
+        mainWidget->setNewStatus(100);
+        mainWidget->setNewLabelText("Installing additional software...");
 
-    // Set exe permissions
-    file.setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+        // Install components and creat shortcuts
+        installOptionalComponents();
 
-    // Close the file
-    file.close();
+#ifdef Q_OS_LINUX
+        // Set last page
+        mainWidget->setCustomContentId(5);
+#endif
+    }
+    else if(installationMode == "update")
+    {
+        /// \todo relaunch the launcher
+#ifdef Q_OS_LINUX
+        createLinuxShortcut(QDir::homePath() + "/.local/share/applications/Relics of Annorath.desktop");
+        createLinuxShortcut(QDir::homePath() + "/Desktop/Relics of Annorath.desktop");
+#endif
 
-    // If phase 0 take future steps
-    switch(downloadPhase)
+#ifdef Q_OS_WIN32
+        createWindowsShortcuts(QString(qgetenv("APPDATA")) + "/Microsoft/Windows/Start Menu/Programs/Relics of Annorath.lnk");
+        createWindowsShortcuts(QStandardPaths::standardLocations(QStandardPaths::DesktopLocation).at(0) + "/Relics of Annorath.lnk");
+#endif
+        mainWidget->setCustomContentId(5);
+    }
+    else if(installationMode == "verify")
+    {
+        QMessageBox::information(NULL,tr("Client verified successfully"), tr("Client verified successfully!"));
+    }
+    else if(installationMode == "repair")
     {
-        case 0:
-            prepareDownload();
-            downloadPhase = 1;
-            break;
-        case 1:
-            getNextFile();
-            break;
+        QMessageBox::information(NULL,tr("Client repaired successfully"), tr("Client repaired successfully!"));
+    }
+    else
+    {
+        // Display infobox
+        QMessageBox::information(NULL,tr("Unknown installation mode"), tr("Something goes wrong, if you get this message please report it and add an step by step description!"));
     }
 }
 
-void ROAInstaller::slot_getSSLError(QNetworkReply* reply, const QList<QSslError> &errors)
+void ROAInstaller::slot_uninstallFinished(bool _success)
 {
-    QSslError sslError = errors.first();
-
-    if(sslError.error() == 11 )
+    if(_success)
     {
-        if(installationMode == "default")
-        {
-            //reply->ignoreSslErrors();
-            mainWidget->setNewLabelText(reply->errorString());
-        }
-        else
-        {
-            /// \todo Add info box
-        }
+        QMessageBox::information(NULL,tr("Client uninstalled successfully"), tr("Client uninstalled successfully!"));
+    }
+    else
+    {
+        QMessageBox::warning(NULL,tr("Client uninstalled failed"), tr("Client uninstalled failed! Please remove left files per hand!"));
     }
 }
 
@@ -0,0 +1,260 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Timing and throughput of the installer phases
+ *
+ * \file    	roametrics.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roametrics.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAMetrics::ROAMetrics()
+{
+    phases << "manifest" << "verify" << "download" << "write" << "postinstall";
+
+    reset();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAMetrics::reset()
+{
+    values.clear();
+    runValues.clear();
+
+    foreach(QString phase, phases)
+    {
+        ROAPhaseMetrics metrics;
+        metrics.duration = 0;
+        metrics.started = -1;
+        metrics.bytes = 0;
+        metrics.files = 0;
+
+        values.insert(phase, metrics);
+    }
+
+    timer.start();
+}
+
+void ROAMetrics::begin(QString _phase)
+{
+    ROAPhaseMetrics &metrics = values[_phase];
+
+    if(metrics.started < 0)
+    {
+        metrics.started = timer.nsecsElapsed();
+    }
+}
+
+void ROAMetrics::end(QString _phase)
+{
+    ROAPhaseMetrics &metrics = values[_phase];
+
+    if(metrics.started >= 0)
+    {
+        metrics.duration += timer.nsecsElapsed() - metrics.started;
+        metrics.started = -1;
+    }
+}
+
+void ROAMetrics::endAll()
+{
+    foreach(QString phase, values.keys())
+    {
+        end(phase);
+    }
+}
+
+void ROAMetrics::addTime(QString _phase, qint64 _nsecs)
+{
+    values[_phase].duration += _nsecs;
+}
+
+void ROAMetrics::addBytes(QString _phase, qint64 _bytes)
+{
+    values[_phase].bytes += _bytes;
+}
+
+void ROAMetrics::addFiles(QString _phase, int _files)
+{
+    values[_phase].files += _files;
+}
+
+void ROAMetrics::setValue(QString _name, double _value)
+{
+    runValues.insert(_name, _value);
+}
+
+double ROAMetrics::getThroughput(QString _phase) const
+{
+    ROAPhaseMetrics metrics = values.value(_phase);
+
+    if(metrics.duration <= 0)
+    {
+        return 0;
+    }
+
+    return metrics.bytes / (metrics.duration / 1000000000.0);
+}
+
+QStringList ROAMetrics::getSummary() const
+{
+    QStringList summary;
+
+    foreach(QString phase, phases)
+    {
+        ROAPhaseMetrics metrics = values.value(phase);
+
+        summary.append(QString("%1: %2 s, %3 files, %4 MB, %5 MB/s")
+                       .arg(phase, -12)
+                       .arg(metrics.duration / 1000000000.0, 0, 'f', 3)
+                       .arg(metrics.files)
+                       .arg(metrics.bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                       .arg(getThroughput(phase) / (1024.0 * 1024.0), 0, 'f', 1));
+    }
+
+    QStringList run;
+
+    QMap<QString, double>::const_iterator i;
+
+    for(i = runValues.constBegin(); i != runValues.constEnd(); ++i)
+    {
+        run.append(i.key() + "=" + QString::number(i.value()));
+    }
+
+    summary.append(run.join(", "));
+
+    return summary;
+}
+
+QMap<QString, double> ROAMetrics::getValues() const
+{
+    QMap<QString, double> all = runValues;
+
+    foreach(QString phase, phases)
+    {
+        ROAPhaseMetrics metrics = values.value(phase);
+
+        all.insert(phase + "_seconds", metrics.duration / 1000000000.0);
+        all.insert(phase + "_bytes", metrics.bytes);
+        all.insert(phase + "_files", metrics.files);
+        all.insert(phase + "_bytes_per_second", getThroughput(phase));
+    }
+
+    return all;
+}
+
+bool ROAMetrics::writePrometheus(QString _fileName) const
+{
+    // The node exporter may read at any time, it must never see a half written file
+    QFile file(_fileName + ".part");
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    out << "# HELP roainstaller_phase_seconds Time spent in the phase of the last run\n";
+    out << "# TYPE roainstaller_phase_seconds gauge\n";
+
+    foreach(QString phase, phases)
+    {
+        out << "roainstaller_phase_seconds{phase=\"" << phase << "\"} " << QString::number(values.value(phase).duration / 1000000000.0, 'f', 6) << "\n";
+    }
+
+    out << "# HELP roainstaller_phase_bytes Bytes handled in the phase of the last run\n";
+    out << "# TYPE roainstaller_phase_bytes gauge\n";
+
+    foreach(QString phase, phases)
+    {
+        out << "roainstaller_phase_bytes{phase=\"" << phase << "\"} " << values.value(phase).bytes << "\n";
+    }
+
+    out << "# HELP roainstaller_phase_files Files handled in the phase of the last run\n";
+    out << "# TYPE roainstaller_phase_files gauge\n";
+
+    foreach(QString phase, phases)
+    {
+        out << "roainstaller_phase_files{phase=\"" << phase << "\"} " << values.value(phase).files << "\n";
+    }
+
+    out << "# HELP roainstaller_phase_bytes_per_second Throughput of the phase of the last run\n";
+    out << "# TYPE roainstaller_phase_bytes_per_second gauge\n";
+
+    foreach(QString phase, phases)
+    {
+        out << "roainstaller_phase_bytes_per_second{phase=\"" << phase << "\"} " << QString::number(getThroughput(phase), 'f', 0) << "\n";
+    }
+
+    QMap<QString, double>::const_iterator i;
+
+    for(i = runValues.constBegin(); i != runValues.constEnd(); ++i)
+    {
+        out << "# TYPE roainstaller_" << i.key() << " gauge\n";
+        out << "roainstaller_" << i.key() << " " << QString::number(i.value(), 'f', 3) << "\n";
+    }
+
+    out << "# TYPE roainstaller_last_run_timestamp_seconds gauge\n";
+    out << "roainstaller_last_run_timestamp_seconds " << QDateTime::currentMSecsSinceEpoch() / 1000 << "\n";
+
+    out.flush();
+    file.close();
+
+    QFile::remove(_fileName);
+
+    return QFile::rename(_fileName + ".part", _fileName);
+}
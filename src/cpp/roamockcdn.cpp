@@ -0,0 +1,615 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Local test server for the engine
+ *
+ * \file    	roamockcdn.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QCryptographicHash>
+#include <QHostAddress>
+#include <QUrl>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roamockcdn.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constants                                                               */
+/*                                                                            */
+/******************************************************************************/
+
+/**
+ * \brief Interval of the send steps in ms, the granularity of latency and bandwidth
+ */
+static const int MOCK_PUMP_INTERVAL = 10;
+
+/**
+ * \brief Size of the generated blocks
+ */
+static const int MOCK_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * \brief Data kept in the socket, more is generated when the client reads it
+ */
+static const qint64 MOCK_SOCKET_BUFFER = 4 * MOCK_CHUNK_SIZE;
+
+/**
+ * \brief Decision about an error response, each kind gets its own number for the same request
+ */
+static const quint64 MOCK_DECIDE_ERROR = 1;
+
+/**
+ * \brief Decision about dropping a file response
+ */
+static const quint64 MOCK_DECIDE_DROP = 2;
+
+/**
+ * \brief Decision about the position of the drop
+ */
+static const quint64 MOCK_DECIDE_DROP_POSITION = 3;
+
+/**
+ * \brief Mix the bits of a number, the content and the random decisions are based on it
+ * \param _value The number
+ * \return The mixed number
+ */
+static quint64 mix(quint64 _value)
+{
+    _value += Q_UINT64_C(0x9e3779b97f4a7c15);
+    _value = (_value ^ (_value >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    _value = (_value ^ (_value >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+
+    return _value ^ (_value >> 31);
+}
+
+/**
+ * \brief Hash a text, unlike qHash the same in every process
+ * \param _text The text
+ * \return The FNV-1a hash of the UTF-8 bytes
+ */
+static quint64 stableHash(const QString &_text)
+{
+    QByteArray bytes = _text.toUtf8();
+    quint64 hash = Q_UINT64_C(0xcbf29ce484222325);
+
+    for(int i = 0; i < bytes.size(); i++)
+    {
+        hash = (hash ^ (quint8)bytes.at(i)) * Q_UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Build the head of a response
+ * \param _status Code and reason
+ * \param _length Length of the body
+ * \param _extra More header lines, each ending with CRLF
+ * \param _close True if the connection is closed after the response
+ * \return The status line and the headers
+ */
+static QByteArray responseHead(QByteArray _status, qint64 _length, QByteArray _extra, bool _close)
+{
+    return "HTTP/1.1 " + _status + "\r\n"
+            + "Content-Length: " + QByteArray::number(_length) + "\r\n"
+            + (_close ? "Connection: close\r\n" : "Connection: keep-alive\r\n")
+            + _extra
+            + "\r\n";
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAMockCdn::ROAMockCdn(QObject *parent) :
+    QObject(parent),
+    server(this),
+    pumpTimer(this)
+{
+    latency = 0;
+    bandwidth = 0;
+    budget = 0;
+    budgetFraction = 0;
+    pumpRound = 0;
+    lastPump = 0;
+    dropRate = 0;
+    errorRate = 0;
+
+    setSeed(1);
+
+    buffer.resize(MOCK_CHUNK_SIZE);
+
+    connect(&server, SIGNAL(newConnection()), this, SLOT(slot_newConnection()));
+
+    pumpTimer.setInterval(MOCK_PUMP_INTERVAL);
+    connect(&pumpTimer, SIGNAL(timeout()), this, SLOT(slot_pump()));
+
+    clock.start();
+    pumpTimer.start();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAMockCdn::generate(int _files, qint64 _size)
+{
+    files.clear();
+    fileIndex.clear();
+    manifest.clear();
+
+    QByteArray block(1024 * 1024, 0);
+
+    for(int i = 0; i < _files; i++)
+    {
+        ROAMockFile file;
+        file.name = QString("game/mock/%1/file%2.pak").arg(i / 100).arg(i);
+        file.size = _size;
+
+        // Independent of the seed of the random decisions, the release stays the same
+        file.seed = (quint64)(i + 1) << 40;
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+
+        for(qint64 offset = 0; offset < file.size; offset += block.size())
+        {
+            qint64 size = qMin((qint64)block.size(), file.size - offset);
+
+            fillData(file, offset, block.data(), size);
+            hash.addData(block.constData(), size);
+        }
+
+        file.hash = QString(hash.result().toHex());
+
+        fileIndex.insert(file.name, files.size());
+        files.append(file);
+
+        manifest += file.name.toUtf8() + ";" + file.hash.toLatin1() + ";" + QByteArray::number(file.size) + "\n";
+    }
+}
+
+void ROAMockCdn::setLatency(int _latency)
+{
+    latency = _latency;
+}
+
+void ROAMockCdn::setBandwidth(qint64 _bandwidth)
+{
+    bandwidth = _bandwidth;
+}
+
+void ROAMockCdn::setDropRate(double _rate)
+{
+    dropRate = _rate;
+}
+
+void ROAMockCdn::setErrorRate(double _rate)
+{
+    errorRate = _rate;
+}
+
+void ROAMockCdn::setSeed(quint64 _seed)
+{
+    seed = mix(_seed);
+}
+
+bool ROAMockCdn::listen(quint16 _port)
+{
+    return server.listen(QHostAddress::LocalHost, _port);
+}
+
+quint16 ROAMockCdn::getPort() const
+{
+    return server.serverPort();
+}
+
+void ROAMockCdn::fillData(const ROAMockFile &_file, qint64 _offset, char *_data, qint64 _size)
+{
+    qint64 i = 0;
+
+    // Every 8 bytes come from their position, any range can be generated on its own
+    while(i < _size)
+    {
+        qint64 position = _offset + i;
+        quint64 word = mix(_file.seed ^ (quint64)(position >> 3));
+
+        for(int byte = position & 7; byte < 8 && i < _size; byte++, i++)
+        {
+            _data[i] = (char)(word >> (byte * 8));
+        }
+    }
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+double ROAMockCdn::decide(QString _path, qint64 _start, int _attempt, quint64 _kind)
+{
+    quint64 value = mix(seed ^ stableHash(_path));
+    value = mix(value ^ (quint64)_start);
+    value = mix(value ^ ((quint64)_attempt << 8) ^ _kind);
+
+    return (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void ROAMockCdn::handleRequests(QTcpSocket *_socket)
+{
+    ROAMockConnection &connection = connections[_socket];
+
+    // Pipelined requests are answered in order
+    if(connection.busy)
+    {
+        return;
+    }
+
+    int headerEnd = connection.input.indexOf("\r\n\r\n");
+
+    if(headerEnd < 0)
+    {
+        return;
+    }
+
+    QList<QByteArray> lines = connection.input.left(headerEnd).split('\n');
+    connection.input.remove(0, headerEnd + 4);
+
+    QList<QByteArray> requestLine = lines.takeFirst().trimmed().split(' ');
+    QHash<QByteArray, QByteArray> headers;
+
+    foreach(QByteArray line, lines)
+    {
+        int colon = line.indexOf(':');
+
+        if(colon > 0)
+        {
+            headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+        }
+    }
+
+    connection.busy = true;
+    connection.readyAt = clock.elapsed() + latency;
+
+    if(requestLine.size() != 3)
+    {
+        connection.close = true;
+        connection.file = -1;
+        connection.output = responseHead("400 Bad Request", 0, QByteArray(), true);
+
+        return;
+    }
+
+    connection.close = (requestLine.at(2) == "HTTP/1.0" || headers.value("connection").toLower() == "close");
+
+    respond(connection, requestLine.at(0), requestLine.at(1), headers);
+}
+
+void ROAMockCdn::respond(ROAMockConnection &_connection, QString _method, QString _path, const QHash<QByteArray, QByteArray> &_headers)
+{
+    _connection.file = -1;
+    _connection.position = 0;
+    _connection.end = 0;
+    _connection.dropAt = -1;
+
+    bool head = (_method == "HEAD");
+
+    if(_method != "GET" && !head)
+    {
+        _connection.output = responseHead("405 Method Not Allowed", 0, QByteArray(), _connection.close);
+        return;
+    }
+
+    // Retries of a request count as attempts, each gets its own decisions
+    QString request = _path + "\n" + _headers.value("range");
+    int attempt = attempts.value(request, 0);
+    attempts.insert(request, attempt + 1);
+
+    if(decide(_path, 0, attempt, MOCK_DECIDE_ERROR) < errorRate)
+    {
+        QByteArray body = "Injected error\n";
+        _connection.output = responseHead("503 Service Unavailable", body.size(), "Content-Type: text/plain\r\n", _connection.close) + (head ? QByteArray() : body);
+        return;
+    }
+
+    // The first directory is the platform, all platforms get the same release
+    QString path = QUrl::fromPercentEncoding(_path.section('?', 0, 0).toUtf8());
+    int slash = path.indexOf('/', 1);
+    QString file = (slash > 0) ? path.mid(slash + 1) : QString();
+
+    if(file.startsWith("launcher/") && file.endsWith(".txt"))
+    {
+        _connection.output = responseHead("200 OK", manifest.size(), "Content-Type: text/plain\r\n", _connection.close) + (head ? QByteArray() : manifest);
+        return;
+    }
+
+    if(!fileIndex.contains(file))
+    {
+        _connection.output = responseHead("404 Not Found", 0, QByteArray(), _connection.close);
+        return;
+    }
+
+    int index = fileIndex.value(file);
+    const ROAMockFile &mock = files.at(index);
+
+    QByteArray etag = "\"" + mock.hash.toLatin1() + "\"";
+    QByteArray range = _headers.value("range");
+
+    qint64 start = 0;
+    qint64 end = mock.size;
+    bool partial = false;
+
+    // Ranges for another version of the file are ignored, the whole file is sent
+    if(range.startsWith("bytes=") && (!_headers.contains("if-range") || _headers.value("if-range") == etag))
+    {
+        QList<QByteArray> bounds = range.mid(6).split('-');
+
+        // Only single ranges, the engine does not use more
+        if(bounds.size() == 2 && !bounds.at(0).isEmpty())
+        {
+            start = bounds.at(0).toLongLong();
+            end = bounds.at(1).isEmpty() ? mock.size : qMin(bounds.at(1).toLongLong() + 1, mock.size);
+            partial = true;
+
+            if(start >= end)
+            {
+                _connection.output = responseHead("416 Range Not Satisfiable", 0, "Content-Range: bytes */" + QByteArray::number(mock.size) + "\r\n", _connection.close);
+                return;
+            }
+        }
+    }
+
+    QByteArray extra = "Content-Type: application/octet-stream\r\nETag: " + etag + "\r\n";
+
+    if(partial)
+    {
+        extra += "Content-Range: bytes " + QByteArray::number(start) + "-" + QByteArray::number(end - 1) + "/" + QByteArray::number(mock.size) + "\r\n";
+    }
+
+    _connection.output = responseHead(partial ? "206 Partial Content" : "200 OK", end - start, extra, _connection.close);
+
+    if(head)
+    {
+        return;
+    }
+
+    _connection.file = index;
+    _connection.position = start;
+    _connection.end = end;
+
+    if(decide(_path, start, attempt, MOCK_DECIDE_DROP) < dropRate)
+    {
+        _connection.dropAt = start + (qint64)(decide(_path, start, attempt, MOCK_DECIDE_DROP_POSITION) * (end - start));
+    }
+}
+
+qint64 ROAMockCdn::send(QTcpSocket *_socket, qint64 _limit)
+{
+    ROAMockConnection &connection = connections[_socket];
+    qint64 sent = 0;
+
+    // Headers and small bodies first
+    if(!connection.output.isEmpty())
+    {
+        qint64 size = (_limit < 0) ? connection.output.size() : qMin(_limit, (qint64)connection.output.size());
+
+        _socket->write(connection.output.constData(), size);
+        connection.output.remove(0, size);
+
+        sent += size;
+    }
+
+    while(connection.output.isEmpty() && connection.file >= 0 && connection.position < connection.end
+          && _socket->bytesToWrite() < MOCK_SOCKET_BUFFER && (_limit < 0 || sent < _limit))
+    {
+        qint64 size = qMin(connection.end - connection.position, (qint64)buffer.size());
+
+        if(_limit >= 0)
+        {
+            size = qMin(size, _limit - sent);
+        }
+
+        if(connection.dropAt >= 0)
+        {
+            size = qMin(size, connection.dropAt - connection.position);
+
+            // The connection is gone after this, the caller must not use it
+            if(size <= 0)
+            {
+                _socket->abort();
+                return sent;
+            }
+        }
+
+        fillData(files.at(connection.file), connection.position, buffer.data(), size);
+        _socket->write(buffer.constData(), size);
+
+        connection.position += size;
+        sent += size;
+    }
+
+    // The response is complete, go on with the next request
+    if(connection.output.isEmpty() && (connection.file < 0 || connection.position >= connection.end))
+    {
+        connection.busy = false;
+        connection.file = -1;
+
+        if(connection.close)
+        {
+            _socket->disconnectFromHost();
+            return sent;
+        }
+
+        handleRequests(_socket);
+    }
+
+    return sent;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Slots                                                                   */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAMockCdn::slot_newConnection()
+{
+    while(server.hasPendingConnections())
+    {
+        QTcpSocket *socket = server.nextPendingConnection();
+
+        ROAMockConnection connection;
+        connection.file = -1;
+        connection.position = 0;
+        connection.end = 0;
+        connection.readyAt = 0;
+        connection.dropAt = -1;
+        connection.busy = false;
+        connection.close = false;
+
+        connections.insert(socket, connection);
+
+        connect(socket, SIGNAL(readyRead()), this, SLOT(slot_readyRead()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(slot_disconnected()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(slot_pump()));
+    }
+}
+
+void ROAMockCdn::slot_readyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+
+    if(!socket || !connections.contains(socket))
+    {
+        return;
+    }
+
+    connections[socket].input += socket->readAll();
+
+    handleRequests(socket);
+
+    // Answer right away, the timer is only needed for latency and bandwidth
+    slot_pump();
+}
+
+void ROAMockCdn::slot_disconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+
+    if(socket)
+    {
+        connections.remove(socket);
+        socket->deleteLater();
+    }
+}
+
+void ROAMockCdn::slot_pump()
+{
+    qint64 now = clock.elapsed();
+
+    if(bandwidth > 0)
+    {
+        // Parts of a byte are kept for the next step, otherwise rates below 1000 bytes per second never send
+        budgetFraction += bandwidth * (now - lastPump);
+        budget += budgetFraction / 1000;
+        budgetFraction %= 1000;
+
+        // No bursts after idle times
+        budget = qMin(budget, qMax(bandwidth / 10, (qint64)1));
+    }
+
+    lastPump = now;
+
+    QList<QTcpSocket*> ready;
+
+    foreach(QTcpSocket *socket, connections.keys())
+    {
+        if(connections.value(socket).busy && connections.value(socket).readyAt <= now)
+        {
+            ready.append(socket);
+        }
+    }
+
+    if(ready.isEmpty())
+    {
+        return;
+    }
+
+    // Another response starts each step, small budgets are not always taken by the same one
+    for(int i = pumpRound++ % ready.size(); i > 0; i--)
+    {
+        ready.append(ready.takeFirst());
+    }
+
+    // The bandwidth is shared equally by the running responses
+    qint64 share = (bandwidth > 0) ? qMax(budget / ready.size(), (qint64)1) : -1;
+
+    if(bandwidth > 0 && budget <= 0)
+    {
+        return;
+    }
+
+    foreach(QTcpSocket *socket, ready)
+    {
+        // Sending can close connections
+        if(!connections.contains(socket))
+        {
+            continue;
+        }
+
+        // With less than a byte for each response the first ones get it
+        if(bandwidth > 0 && budget <= 0)
+        {
+            break;
+        }
+
+        qint64 sent = send(socket, (bandwidth > 0) ? qMin(share, budget) : share);
+
+        if(bandwidth > 0)
+        {
+            budget -= sent;
+        }
+    }
+}
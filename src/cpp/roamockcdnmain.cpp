@@ -0,0 +1,128 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Starts the local test server
+ *
+ * \file    	roamockcdnmain.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roamockcdn.h"
+
+/**
+ * \brief Get the value of an option
+ *
+ * \param[in] _arguments The arguments.
+ * \param[in] _option The option, e.g. --port.
+ * \param[in] _default The value if the option is missing.
+ *
+ * \return The value.
+ */
+static QString optionValue(const QStringList &_arguments, QString _option, QString _default)
+{
+    int index = _arguments.indexOf(_option);
+
+    if(index < 0 || index + 1 >= _arguments.size())
+    {
+        return _default;
+    }
+
+    return _arguments.at(index + 1);
+}
+
+/**
+ * \brief Serve a synthetic release until the process is stopped
+ *
+ * \param[in] argc Count of arguments.
+ * \param[in] *argv Array with the arguments.
+ *
+ * \return 0 when stopped, 1 if the port is not free.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QStringList arguments = a.arguments();
+
+    if(arguments.contains("--help"))
+    {
+        QTextStream(stdout) << "Options:\n"
+                               "   --port <port> - Port on 127.0.0.1, default 8080, 0 for any free port\n"
+                               "   --files <count> - Files of the release, default 100\n"
+                               "   --size <bytes> - Size of each file, default 1048576\n"
+                               "   --latency <ms> - Delay of each response, default 0\n"
+                               "   --bandwidth <bytes> - Bytes per second of all connections, default 0 for no limit\n"
+                               "   --drop <percent> - File responses dropped in the middle of the body, default 0\n"
+                               "   --error <percent> - Requests answered with 503, default 0\n"
+                               "   --seed <number> - Seed of the drops and errors, default 1\n"
+                               "   \n"
+                               "Sample: roamockcdn --latency 50 --bandwidth 10485760 &\n"
+                               "        roainstaller --headless --path /tmp/roa --base-url http://127.0.0.1:8080/ install\n";
+
+        return 0;
+    }
+
+    ROAMockCdn cdn;
+
+    cdn.setLatency(optionValue(arguments, "--latency", "0").toInt());
+    cdn.setBandwidth(optionValue(arguments, "--bandwidth", "0").toLongLong());
+    cdn.setDropRate(optionValue(arguments, "--drop", "0").toDouble() / 100.0);
+    cdn.setErrorRate(optionValue(arguments, "--error", "0").toDouble() / 100.0);
+    cdn.setSeed(optionValue(arguments, "--seed", "1").toULongLong());
+
+    int files = optionValue(arguments, "--files", "100").toInt();
+    qint64 size = optionValue(arguments, "--size", "1048576").toLongLong();
+
+    cdn.generate(files, size);
+
+    if(!cdn.listen(optionValue(arguments, "--port", "8080").toUShort()))
+    {
+        QTextStream(stderr) << "Could not listen on the port\n";
+        return 1;
+    }
+
+    QTextStream(stdout) << "Serving " << files << " files of " << size << " bytes, use --base-url http://127.0.0.1:" << cdn.getPort() << "/\n";
+
+    return a.exec();
+}
@@ -0,0 +1,204 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Byte based progress of the downloads with throughput and remaining time
+ *
+ * \file    	roaprogress.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roaprogress.h"
+
+#include <math.h>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constants                                                               */
+/*                                                                            */
+/******************************************************************************/
+
+/**
+ * \brief Time constant of the smoothing in seconds, short enough to follow changes of the link
+ */
+static const double PROGRESS_SMOOTHING = 3.0;
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROAProgress::ROAProgress()
+{
+    reset();
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+void ROAProgress::reset()
+{
+    sizes.clear();
+    received.clear();
+
+    total = 0;
+    finished = 0;
+    receivedTotal = 0;
+    lastSample = 0;
+    lastReceived = 0;
+    lastDone = 0;
+    throughput = -1;
+    rate = -1;
+
+    timer.start();
+}
+
+void ROAProgress::addFile(QString _file, qint64 _size)
+{
+    if(_size < 0)
+    {
+        _size = 0;
+    }
+
+    sizes.insert(_file, _size);
+    total += _size;
+}
+
+void ROAProgress::setFileSize(QString _file, qint64 _size)
+{
+    if(sizes.value(_file, -1) == 0 && _size > 0)
+    {
+        sizes.insert(_file, _size);
+        total += _size;
+    }
+}
+
+void ROAProgress::addReceived(QString _file, qint64 _bytes)
+{
+    receivedTotal += _bytes;
+
+    if(sizes.contains(_file))
+    {
+        received[_file] += _bytes;
+    }
+}
+
+qint64 ROAProgress::getReceived(QString _file) const
+{
+    return received.value(_file);
+}
+
+void ROAProgress::finishFile(QString _file)
+{
+    if(sizes.contains(_file))
+    {
+        finished += sizes.take(_file);
+        received.remove(_file);
+    }
+}
+
+void ROAProgress::sample()
+{
+    qint64 now = timer.nsecsElapsed();
+    double seconds = (now - lastSample) / 1000000000.0;
+
+    if(seconds <= 0)
+    {
+        return;
+    }
+
+    qint64 done = getDone();
+
+    double currentThroughput = (receivedTotal - lastReceived) / seconds;
+    double currentRate = (done - lastDone) / seconds;
+
+    // Exponential moving average, the weight depends on the time since the last sample
+    double alpha = 1.0 - exp(-seconds / PROGRESS_SMOOTHING);
+
+    throughput = (throughput < 0) ? currentThroughput : throughput + alpha * (currentThroughput - throughput);
+    rate = (rate < 0) ? currentRate : rate + alpha * (currentRate - rate);
+
+    lastSample = now;
+    lastReceived = receivedTotal;
+    lastDone = done;
+}
+
+int ROAProgress::getPercent() const
+{
+    if(total <= 0)
+    {
+        return 0;
+    }
+
+    return qMin((qint64)100, getDone() * 100 / total);
+}
+
+qint64 ROAProgress::getDone() const
+{
+    qint64 done = finished;
+
+    // Resumed or retried files may receive more than their size
+    QHash<QString, qint64>::const_iterator it;
+
+    for(it = received.constBegin(); it != received.constEnd(); ++it)
+    {
+        done += qMin(it.value(), sizes.value(it.key()));
+    }
+
+    return done;
+}
+
+qint64 ROAProgress::getTotal() const
+{
+    return total;
+}
+
+double ROAProgress::getThroughput() const
+{
+    return qMax(0.0, throughput);
+}
+
+qint64 ROAProgress::getRemainingTime() const
+{
+    if(rate <= 0)
+    {
+        return -1;
+    }
+
+    return (qint64)((total - getDone()) / rate);
+}
@@ -0,0 +1,308 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Streaming extraction of tar bundles
+ *
+ * \file    	roatarextractor.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roatarextractor.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constants                                                               */
+/*                                                                            */
+/******************************************************************************/
+
+/**
+ * \brief Tar archives are written in blocks of 512 bytes
+ */
+static const int TAR_BLOCK_SIZE = 512;
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROATarExtractor::ROATarExtractor(QString _installationPath, const QHash<QString, QString> &_members) :
+    installationPath(_installationPath),
+    members(_members),
+    state(Header),
+    remaining(0),
+    padding(0),
+    file(0),
+    hash(0),
+    failed(false)
+{
+    block.reserve(TAR_BLOCK_SIZE);
+
+    open(QIODevice::WriteOnly);
+}
+
+ROATarExtractor::~ROATarExtractor()
+{
+    // The stream ended inside of a member
+    if(file)
+    {
+        file->close();
+        QFile::remove(file->fileName());
+        delete file;
+        delete hash;
+    }
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+QStringList ROATarExtractor::getExtractedFiles() const
+{
+    return extracted;
+}
+
+bool ROATarExtractor::isFinished() const
+{
+    return state == End && !failed;
+}
+
+QHash<QString, qint64> ROATarExtractor::takeWrittenBytes()
+{
+    QHash<QString, qint64> bytes = written;
+    written.clear();
+
+    return bytes;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Protected methods                                                       */
+/*                                                                            */
+/******************************************************************************/
+
+qint64 ROATarExtractor::readData(char *_data, qint64 _size)
+{
+    Q_UNUSED(_data);
+    Q_UNUSED(_size);
+
+    return -1;
+}
+
+qint64 ROATarExtractor::writeData(const char *_data, qint64 _size)
+{
+    qint64 position = 0;
+
+    while(position < _size && state != End)
+    {
+        qint64 available = _size - position;
+
+        if(state == Header)
+        {
+            int size = qMin((qint64)(TAR_BLOCK_SIZE - block.size()), available);
+            block.append(_data + position, size);
+            position += size;
+
+            if(block.size() == TAR_BLOCK_SIZE)
+            {
+                parseHeader();
+                block.clear();
+            }
+        }
+        else if(state == Data)
+        {
+            qint64 size = qMin(remaining, available);
+
+            if(file)
+            {
+                file->write(_data + position, size);
+                hash->addData(_data + position, size);
+
+                written[name] += size;
+            }
+
+            position += size;
+            remaining -= size;
+
+            if(remaining == 0)
+            {
+                finishMember();
+            }
+        }
+        else if(state == Padding)
+        {
+            qint64 size = qMin(padding, available);
+            position += size;
+            padding -= size;
+
+            if(padding == 0)
+            {
+                state = Header;
+            }
+        }
+    }
+
+    // Data after the end of the archive is ignored
+    return _size;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+void ROATarExtractor::parseHeader()
+{
+    // A zero block marks the end of the archive
+    if(block.count('\0') == TAR_BLOCK_SIZE)
+    {
+        state = End;
+        return;
+    }
+
+    // The checksum is calculated with the checksum field filled with spaces
+    qint64 checksum = 0;
+
+    for(int i = 0; i < TAR_BLOCK_SIZE; i++)
+    {
+        checksum += (i >= 148 && i < 156) ? ' ' : (uchar)block.at(i);
+    }
+
+    remaining = readOctal(124, 12);
+
+    if(checksum != readOctal(148, 8) || remaining < 0)
+    {
+        failed = true;
+        state = End;
+        return;
+    }
+
+    padding = (TAR_BLOCK_SIZE - remaining % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+    char type = block.at(156);
+
+    // Pax headers and GNU long names are not supported, the names of the members would be wrong
+    if(type == 'x' || type == 'g' || type == 'L' || type == 'K')
+    {
+        failed = true;
+        state = End;
+        return;
+    }
+
+    // The ustar prefix holds the directories of long names
+    QByteArray prefix = readString(345, 155);
+
+    if(block.mid(257, 5) == "ustar" && !prefix.isEmpty())
+    {
+        name = QString::fromUtf8(prefix + "/" + readString(0, 100));
+    }
+    else
+    {
+        name = QString::fromUtf8(readString(0, 100));
+    }
+
+    if(name.startsWith("./"))
+    {
+        name.remove(0, 2);
+    }
+
+    // Only the listed files are extracted, this also keeps the archive inside of the installation path
+    if((type == '0' || type == '\0') && members.contains(name))
+    {
+        file = new QFile(installationPath + name + ".part");
+
+        if(file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            hash = new QCryptographicHash(QCryptographicHash::Sha256);
+        }
+        else
+        {
+            delete file;
+            file = 0;
+        }
+    }
+
+    state = Data;
+
+    if(remaining == 0)
+    {
+        finishMember();
+    }
+}
+
+void ROATarExtractor::finishMember()
+{
+    if(file)
+    {
+        file->setPermissions(QFile::ExeUser | QFile::ExeGroup | QFile::ExeOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOwner | QFile::ReadUser);
+        file->close();
+
+        // Keep the member only if it is the file from the file list
+        if(QString(hash->result().toHex()) == members.value(name))
+        {
+            extracted.append(name);
+        }
+        else
+        {
+            QFile::remove(file->fileName());
+        }
+
+        delete file;
+        delete hash;
+        file = 0;
+        hash = 0;
+    }
+
+    state = (padding > 0) ? Padding : Header;
+}
+
+qint64 ROATarExtractor::readOctal(int _offset, int _size) const
+{
+    bool ok;
+    qint64 value = readString(_offset, _size).trimmed().toLongLong(&ok, 8);
+
+    return ok ? value : -1;
+}
+
+QByteArray ROATarExtractor::readString(int _offset, int _size) const
+{
+    QByteArray field = block.mid(_offset, _size);
+    int end = field.indexOf('\0');
+
+    return (end >= 0) ? field.left(end) : field;
+}
@@ -0,0 +1,227 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Chrome trace of the install pipeline
+ *
+ * \file    	roatrace.cpp
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QMutexLocker>
+#include <QJsonDocument>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include "../h/roatrace.h"
+
+/******************************************************************************/
+/*                                                                            */
+/*    Constructor/Deconstructor                                               */
+/*                                                                            */
+/******************************************************************************/
+
+ROATrace::ROATrace(QString _fileName) :
+    file(_fileName),
+    first(true)
+{
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        file.write("[\n");
+    }
+
+    timer.start();
+}
+
+ROATrace::~ROATrace()
+{
+    if(file.isOpen())
+    {
+        file.write("\n]\n");
+        file.close();
+    }
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Public methods                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+bool ROATrace::isOpen() const
+{
+    return file.isOpen();
+}
+
+qint64 ROATrace::now() const
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+void ROATrace::complete(QString _name, qint64 _start, QString _file)
+{
+    qint64 end = now();
+
+    QJsonObject args;
+    args.insert("file", _file);
+
+    QJsonObject event;
+    event.insert("name", _name);
+    event.insert("cat", _name);
+    event.insert("ph", QString("X"));
+    event.insert("ts", (double)_start);
+    event.insert("dur", (double)(end - _start));
+    event.insert("args", args);
+
+    QMutexLocker locker(&mutex);
+    write(event);
+}
+
+void ROATrace::instant(QString _name, QString _file)
+{
+    QJsonObject args;
+    args.insert("file", _file);
+
+    QJsonObject event;
+    event.insert("name", _name);
+    event.insert("cat", _name);
+    event.insert("ph", QString("i"));
+    event.insert("s", QString("t"));
+    event.insert("ts", (double)now());
+    event.insert("args", args);
+
+    QMutexLocker locker(&mutex);
+    write(event);
+}
+
+void ROATrace::asyncBegin(QString _name, const void *_id, QString _file)
+{
+    QJsonObject args;
+    args.insert("file", _file);
+
+    QJsonObject event;
+    event.insert("name", _name);
+    event.insert("cat", QString("request"));
+    event.insert("ph", QString("b"));
+    event.insert("id", "0x" + QString::number((quintptr)_id, 16));
+    event.insert("ts", (double)now());
+    event.insert("args", args);
+
+    QMutexLocker locker(&mutex);
+    write(event);
+}
+
+void ROATrace::asyncEnd(QString _name, const void *_id)
+{
+    QJsonObject event;
+    event.insert("name", _name);
+    event.insert("cat", QString("request"));
+    event.insert("ph", QString("e"));
+    event.insert("id", "0x" + QString::number((quintptr)_id, 16));
+    event.insert("ts", (double)now());
+
+    QMutexLocker locker(&mutex);
+    write(event);
+}
+
+/******************************************************************************/
+/*                                                                            */
+/*    Private methods                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+void ROATrace::write(QJsonObject _event)
+{
+    if(!file.isOpen())
+    {
+        return;
+    }
+
+    _event.insert("pid", 1);
+    _event.insert("tid", threadId());
+
+    if(!first)
+    {
+        file.write(",\n");
+    }
+
+    first = false;
+
+    file.write(QJsonDocument(_event).toJson(QJsonDocument::Compact));
+}
+
+int ROATrace::threadId()
+{
+    Qt::HANDLE handle = QThread::currentThreadId();
+
+    if(threads.contains(handle))
+    {
+        return threads.value(handle);
+    }
+
+    int id = threads.size() + 1;
+    threads.insert(handle, id);
+
+    // Name the track, pooled threads have no own name
+    QString name = QThread::currentThread()->objectName();
+
+    if(name.isEmpty() || name == "Thread (pooled)")
+    {
+        name = QString("thread %1").arg(id);
+    }
+
+    QJsonObject args;
+    args.insert("name", name);
+
+    QJsonObject event;
+    event.insert("name", QString("thread_name"));
+    event.insert("ph", QString("M"));
+    event.insert("pid", 1);
+    event.insert("tid", id);
+    event.insert("args", args);
+
+    if(!first)
+    {
+        file.write(",\n");
+    }
+
+    first = false;
+
+    file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+
+    return id;
+}
@@ -0,0 +1,150 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Benchmarks of the engine
+ *
+ * \file    	roabenchmark.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROABENCHMARK_H
+#define ROABENCHMARK_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+/**
+ * \brief Benchmarks of hashing, reading the file list and removing directories
+ *
+ * Run it with -csv or -o results.xml,xml for machine readable results.
+ */
+class ROABenchmark : public QObject
+{
+        Q_OBJECT
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Directory for the generated files, removed after the run
+         */
+        QTemporaryDir tempDir;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Write a file with pseudo random content
+         * \param _fileName The file
+         * \param _size The size in bytes
+         * \return The SHA-256 of the content as hex string
+         */
+        QString writeFile(QString _fileName, qint64 _size);
+
+        /**
+         * \brief Write a file list with synthetic entries
+         * \param _fileName The file list
+         * \param _entries Amount of entries
+         */
+        void writeFileList(QString _fileName, int _entries);
+
+        /**
+         * \brief Create a directory tree
+         * \param _dir The root of the tree
+         * \param _depth Levels below the root
+         * \param _width Sub directories per directory
+         * \param _files Files per directory
+         */
+        void createTree(QString _dir, int _depth, int _width, int _files);
+
+    private slots:
+
+        /**
+         * \brief Checks if the files can be generated
+         */
+        void initTestCase();
+
+        /**
+         * \brief File sizes for checkFileWithHash
+         */
+        void checkFileWithHash_data();
+
+        /**
+         * \brief Hashes a file with checkFileWithHash
+         */
+        void checkFileWithHash();
+
+        /**
+         * \brief Entry counts for parseFileList
+         */
+        void parseFileList_data();
+
+        /**
+         * \brief Reads a file list with parseFileList
+         */
+        void parseFileList();
+
+        /**
+         * \brief Entry counts for ROAFileListParser
+         */
+        void fileListParser_data();
+
+        /**
+         * \brief Splits a file list in memory, the result are entries per second reported as events
+         */
+        void fileListParser();
+
+        /**
+         * \brief Tree shapes for removeDirWithContent
+         */
+        void removeDirWithContent_data();
+
+        /**
+         * \brief Removes a tree with removeDirWithContent
+         */
+        void removeDirWithContent();
+};
+
+#endif // ROABENCHMARK_H
@@ -0,0 +1,197 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Content defined chunks of installed files for reuse in new releases
+ *
+ * \file    	roachunkstore.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROACHUNKSTORE_H
+#define ROACHUNKSTORE_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QList>
+#include <QMultiHash>
+#include <QSet>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QCryptographicHash>
+
+/**
+ * \brief A chunk of a file
+ */
+struct ROAChunk
+{
+    /**
+     * \brief SHA-256 of the chunk data as hex string
+     */
+    QString hash;
+
+    /**
+     * \brief Size of the chunk in bytes
+     */
+    qint64 size;
+};
+
+/**
+ * \brief Place of a chunk in an installed file
+ */
+struct ROAChunkLocation
+{
+    /**
+     * \brief The file, relative to the installation path
+     */
+    QString file;
+
+    /**
+     * \brief Offset of the chunk in the file
+     */
+    qint64 offset;
+
+    /**
+     * \brief Size of the chunk in bytes
+     */
+    qint64 size;
+};
+
+/**
+ * \brief Knows which chunks are available in the installed files
+ *
+ * Installed files with a chunk index are remembered with the offsets of their chunks.
+ * New releases read matching chunks from there instead of downloading them again.
+ * The data is always verified against the chunk hash, files changed since are detected.
+ */
+class ROAChunkStore
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         */
+        ROAChunkStore();
+
+        /**
+         * \brief Load the known chunks, chunks in memory are replaced
+         * \param _installationPath The installation path
+         * \return True if the file was read
+         */
+        bool load(QString _installationPath);
+
+        /**
+         * \brief Save the known chunks
+         * \return True if the file was written
+         */
+        bool save();
+
+        /**
+         * \brief Parse a chunk index
+         *
+         * Format: one chunk per line, hash;size
+         *
+         * \param _file The absolute path of the index
+         * \param _chunks Receives the chunks in file order
+         * \return True if the index was read and is valid
+         */
+        static bool readIndex(QString _file, QList<ROAChunk> *_chunks);
+
+        /**
+         * \brief Parse a chunk index held in memory
+         * \param _data The content of the index
+         * \param _chunks Receives the chunks in file order
+         * \return True if the index is valid
+         */
+        static bool parseIndex(const QByteArray &_data, QList<ROAChunk> *_chunks);
+
+        /**
+         * \brief Read a chunk from an installed file
+         * \param _chunk The chunk to read
+         * \param _data Receives the verified data
+         * \return True if the chunk was found
+         */
+        bool readChunk(const ROAChunk &_chunk, QByteArray *_data);
+
+        /**
+         * \brief Remember the chunks of an installed file, old chunks of the file are forgotten
+         * \param _file The file, relative to the installation path
+         * \param _chunks The chunks in file order
+         */
+        void addFile(QString _file, const QList<ROAChunk> &_chunks);
+
+        /**
+         * \brief Forget the chunks of a file, e.g. when it is replaced
+         * \param _file The file, relative to the installation path
+         */
+        void removeFile(QString _file);
+
+        /**
+         * \brief Check if the chunks of a file are known
+         * \param _file The file, relative to the installation path
+         * \return True if the file was added
+         */
+        bool contains(QString _file) const;
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The installation path
+         */
+        QString installationPath;
+
+        /**
+         * \brief The places of the chunks mapped to their hash
+         */
+        QMultiHash<QString, ROAChunkLocation> chunks;
+
+        /**
+         * \brief The hashes of the chunks mapped to their file, replacing a file does not scan all chunks
+         */
+        QHash<QString, QSet<QString> > files;
+};
+
+#endif // ROACHUNKSTORE_H
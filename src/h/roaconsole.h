@@ -0,0 +1,287 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Headless installer, reports to the console instead of widgets
+ *
+ * \file    	roaconsole.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROACONSOLE_H
+#define ROACONSOLE_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QObject>
+#include <QCoreApplication>
+#include <QSettings>
+#include <QTimer>
+#include <QTextStream>
+#include <QStringList>
+#include <QScopedPointer>
+
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+#include "../h/roaengine.h"
+#include "../h/roaenginethread.h"
+#include "../h/roaeventwriter.h"
+
+/**
+ * \brief Runs the engine without widgets, for servers and containers
+ *
+ * Progress goes to stdout, problems to stderr. The application exits with
+ * 0 on success, 1 if files could not be downloaded or removed and 2 if nothing could be done.
+ */
+class ROAConsole : public QObject
+{
+        Q_OBJECT
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor, the installation path is read from the settings
+         * \param parent The parent
+         */
+        explicit ROAConsole(QObject *parent = 0);
+
+        /**
+         * \brief Deconstuctor
+         */
+        ~ROAConsole();
+
+        /**
+         * \brief Use another installation path and remember it in the settings
+         * \param _path The installation path
+         */
+        void setInstallationPath(QString _path);
+
+        /**
+         * \brief Ignore the hash cache and hash all files
+         * \param _deep True to hash all files
+         */
+        void setDeepVerify(bool _deep);
+
+        /**
+         * \brief Write the human readable output to stderr, stdout is free for the event stream
+         * \param _stderr True to write to stderr
+         */
+        void setLogToStderr(bool _stderr);
+
+        /**
+         * \brief Forward the callbacks of the engine, must be called before run()
+         * \param _listener The callbacks, they are called on the engine thread
+         */
+        void addListener(ROAEngineListener *_listener);
+
+        /**
+         * \brief Write the metrics of the run for the Prometheus textfile collector
+         * \param _fileName The file, should end with .prom
+         */
+        void setMetricsFile(QString _fileName);
+
+        /**
+         * \brief Trace the run in the Chrome trace event format
+         * \param _fileName The trace file, empty to disable tracing
+         */
+        void setTraceFile(QString _fileName);
+
+        /**
+         * \brief Download from another server, e.g. a mirror or a local test server
+         * \param _url The url of the data directory, empty to use the baseUrl setting
+         */
+        void setBaseUrl(QString _url);
+
+        /**
+         * \brief Start an action, the application exits when it is done
+         * \param _mode The installation mode (default, update, verify, repair or uninstall)
+         */
+        void run(QString _mode);
+
+        /**
+         * \brief Parse the arguments and run the action, no display is needed
+         * \param argc Count of arguments
+         * \param argv Array with the arguments
+         * \return 0 on success, 1 if files failed, 2 if nothing could be done
+         */
+        static int runHeadless(int argc, char *argv[]);
+
+        /**
+         * \brief Remove an option with a value from the arguments
+         * \param _arguments The arguments
+         * \param _option The option, e.g. --path
+         * \param _value The value, untouched if the option is missing
+         * \return False if the option has no value
+         */
+        static bool takeOption(QStringList &_arguments, QString _option, QString &_value);
+
+        /**
+         * \brief Open the event stream
+         * \param _target The file or named pipe, - for stdout
+         * \return The writer, NULL if the target could not be opened
+         */
+        static ROAEventWriter *openEvents(QString _target);
+
+    signals:
+
+        /**
+         * \brief Start the engine on its thread
+         * \param _installationPath The installation path with ending slash
+         * \param _mode The installation mode
+         * \param _deep True to ignore the hash cache
+         */
+        void startEngine(QString _installationPath, QString _mode, bool _deep);
+
+        /**
+         * \brief Remove the installation on the engine thread
+         * \param _installationPath The installation path with ending slash
+         */
+        void startUninstall(QString _installationPath);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The user settings
+         */
+        QSettings *userSettings;
+
+        /**
+         * \brief Installation path, empty if unknown
+         */
+        QString installationPath;
+
+        /**
+         * \brief Ignore the hash cache and hash all files
+         */
+        bool deepVerify;
+
+        /**
+         * \brief Write the human readable output to stderr
+         */
+        bool logToStderr;
+
+        /**
+         * \brief Last progress written, the progress is only written when it changes
+         */
+        int lastPercent;
+
+        /**
+         * \brief Exit code of the application
+         */
+        int exitCode;
+
+        /**
+         * \brief The engine, it lives on the engine thread
+         */
+        ROAEngine *engine;
+
+        /**
+         * \brief Thread of the engine
+         */
+        ROAEngineThread engineThread;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Write a line to stdout, or stderr if the event stream uses stdout
+         * \param _text The text to write
+         */
+        void printLine(QString _text);
+
+        /**
+         * \brief Write a line to stderr and exit
+         * \param _text The error to write
+         * \param _code The exit code
+         */
+        void fail(QString _text, int _code);
+
+        /**
+         * \brief Exit the application once the event loop runs
+         * \param _code The exit code
+         */
+        void exitLater(int _code);
+
+    private slots:
+
+        /**
+         * \brief Writes the progress of the engine
+         * \param _percent The progress in percent
+         * \param _text Current file, throughput and remaining time
+         */
+        void slot_engineProgress(int _percent, QString _text);
+
+        /**
+         * \brief Writes problems reported by the engine
+         * \param _message The description of the problem
+         */
+        void slot_engineError(QString _message);
+
+        /**
+         * \brief Writes the summary and exits
+         * \param _success False if the run was stopped, the reason was reported before
+         * \param _failedFiles Files which could not be downloaded
+         */
+        void slot_engineFinished(bool _success, QStringList _failedFiles);
+
+        /**
+         * \brief Writes the result of the uninstallation and exits
+         * \param _success False if files are left
+         */
+        void slot_uninstallFinished(bool _success);
+
+        /**
+         * \brief Exits the application with the exit code
+         */
+        void slot_exit();
+};
+
+#endif // ROACONSOLE_H
@@ -0,0 +1,170 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Streaming decompression of downloaded data
+ *
+ * \file    	roadecompressor.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROADECOMPRESSOR_H
+#define ROADECOMPRESSOR_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+#include <QCryptographicHash>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+#include <zstd.h>
+#include <zlib.h>
+
+/**
+ * \brief Decompresses zstd or gzip data chunk by chunk into a device
+ */
+class ROADecompressor
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Supported formats
+         */
+        enum Format
+        {
+            None,
+            Zstd,
+            Gzip
+        };
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         * \param _format The format of the compressed data
+         */
+        explicit ROADecompressor(Format _format);
+
+        /**
+         * \brief Deconstructor
+         */
+        ~ROADecompressor();
+
+        /**
+         * \brief Get the format for a file suffix
+         * \param _suffix The suffix, "zst" or "gz"
+         * \return The format, None if unknown
+         */
+        static Format formatFromSuffix(QString _suffix);
+
+        /**
+         * \brief Use data as prefix, needed for zstd patches (zstd --patch-from)
+         *
+         * The data must stay valid until the decompression is finished.
+         *
+         * \param _data The prefix
+         * \param _size The size of the prefix
+         */
+        void setPrefix(const uchar *_data, qint64 _size);
+
+        /**
+         * \brief Decompress a chunk and write the result
+         * \param _data The compressed data
+         * \param _size The size of the compressed data
+         * \param _target The device to write the decompressed data to
+         * \param _hash If set, the decompressed data is added
+         * \return False if the data is broken
+         */
+        bool write(const char *_data, qint64 _size, QIODevice *_target, QCryptographicHash *_hash = 0);
+
+        /**
+         * \brief Check if the compressed stream ended at a frame boundary
+         * \return True if all data was decompressed without error
+         */
+        bool isFinished() const;
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The format of the compressed data
+         */
+        Format format;
+
+        /**
+         * \brief Context for zstd
+         */
+        ZSTD_DCtx *zstdContext;
+
+        /**
+         * \brief Stream for gzip
+         */
+        z_stream *gzipStream;
+
+        /**
+         * \brief Reusable buffer for the decompressed data
+         */
+        QByteArray buffer;
+
+        /**
+         * \brief True if the last frame is complete
+         */
+        bool finished;
+
+        /**
+         * \brief True if the data was broken
+         */
+        bool failed;
+};
+
+#endif // ROADECOMPRESSOR_H
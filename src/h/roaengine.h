@@ -0,0 +1,1381 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Download and verification engine, runs on its own thread
+ *
+ * \file    	roaengine.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAENGINE_H
+#define ROAENGINE_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QObject>
+#include <QCoreApplication>
+#include <QSettings>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QSslConfiguration>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QSslError>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <QHash>
+#include <QSet>
+#include <QBuffer>
+#include <QUrl>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+#include <QThread>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentMap>
+
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+#include "../h/roahashcache.h"
+#include "../h/roadecompressor.h"
+#include "../h/roachunkstore.h"
+#include "../h/roatarextractor.h"
+#include "../h/roaprogress.h"
+#include "../h/roametrics.h"
+#include "../h/roatrace.h"
+#include "../h/roafilelistparser.h"
+
+
+/**
+ * \brief Byte range of a large file downloaded on its own connection
+ */
+struct ROASegment
+{
+    /**
+     * \brief First byte of the segment
+     */
+    qint64 start;
+
+    /**
+     * \brief First byte after the segment
+     */
+    qint64 end;
+
+    /**
+     * \brief Next byte to write
+     */
+    qint64 position;
+
+    /**
+     * \brief Number of the current download attempt
+     */
+    int attempt;
+};
+
+/**
+ * \brief State of a large file downloaded in several segments at the same time
+ */
+struct ROASegmentedDownload
+{
+    /**
+     * \brief Index in the file list
+     */
+    int index;
+
+    /**
+     * \brief The file to create, relative to the installation path
+     */
+    QString fileName;
+
+    /**
+     * \brief The url of the file
+     */
+    QUrl url;
+
+    /**
+     * \brief The preallocated temporary file all segments are written to
+     */
+    QFile *file;
+
+    /**
+     * \brief Hash of the file, the data is added in order as soon as it is available
+     */
+    QCryptographicHash *hash;
+
+    /**
+     * \brief Offset up to which the data is hashed
+     */
+    qint64 hashed;
+
+    /**
+     * \brief The segments of the file
+     */
+    QList<ROASegment> segments;
+
+    /**
+     * \brief Amount of segments still downloading
+     */
+    int running;
+
+    /**
+     * \brief Amount of segments waiting for a free download slot
+     */
+    int waiting;
+
+    /**
+     * \brief True if a segment could not be downloaded
+     */
+    bool failed;
+
+    /**
+     * \brief False if the server ignored the range request
+     */
+    bool rangesSupported;
+};
+
+/**
+ * \brief Segment of a large file waiting for a free download slot
+ */
+struct ROASegmentRequest
+{
+    /**
+     * \brief The large file
+     */
+    ROASegmentedDownload *segmented;
+
+    /**
+     * \brief The index of the segment
+     */
+    int segment;
+};
+
+/**
+ * \brief File assembled from chunks, the chunks missing locally are downloaded
+ */
+struct ROAChunkedDownload
+{
+    /**
+     * \brief Index in the file list
+     */
+    int index;
+
+    /**
+     * \brief The chunks of the file in file order
+     */
+    QList<ROAChunk> chunks;
+
+    /**
+     * \brief The preallocated temporary file the chunks are written to
+     */
+    QFile *file;
+
+    /**
+     * \brief Offsets of the missing chunks mapped to their hash, a chunk can be used more than once
+     */
+    QHash<QString, QList<qint64> > missing;
+
+    /**
+     * \brief Amount of chunk downloads queued or running
+     */
+    int running;
+
+    /**
+     * \brief True if a chunk could not be downloaded
+     */
+    bool failed;
+};
+
+/**
+ * \brief Download of a single chunk
+ */
+struct ROAChunkRequest
+{
+    /**
+     * \brief The file the chunk belongs to
+     */
+    ROAChunkedDownload *download;
+
+    /**
+     * \brief The chunk
+     */
+    ROAChunk chunk;
+
+    /**
+     * \brief Number of the current download attempt
+     */
+    int attempt;
+};
+
+/**
+ * \brief Download of the chunk index of an installed file, its chunks can be reused by later releases
+ */
+struct ROAChunkIndexRequest
+{
+    /**
+     * \brief The file, relative to the installation path
+     */
+    QString file;
+
+    /**
+     * \brief SHA-256 of the chunk index from the file list
+     */
+    QString hash;
+
+    /**
+     * \brief Number of the current download attempt
+     */
+    int attempt;
+};
+
+/**
+ * \brief Content of a download
+ */
+enum ROADownloadType
+{
+    ROADownloadFile,
+    ROADownloadPatch,
+    ROADownloadChunkIndex,
+    ROADownloadBundle
+};
+
+/**
+ * \brief State of a running download
+ */
+struct ROADownload
+{
+    /**
+     * \brief Index in the file list, -1 for the file list itself
+     */
+    int index;
+
+    /**
+     * \brief The file to create, relative to the installation path
+     */
+    QString fileName;
+
+    /**
+     * \brief The temporary file the received data is written to
+     */
+    QFile *file;
+
+    /**
+     * \brief Hash of the received data
+     */
+    QCryptographicHash *hash;
+
+    /**
+     * \brief Number of the current download attempt
+     */
+    int attempt;
+
+    /**
+     * \brief Size of the partial file the download was resumed from
+     */
+    qint64 offset;
+
+    /**
+     * \brief True once the response headers were checked
+     */
+    bool headersHandled;
+
+    /**
+     * \brief True if the response contains the requested data
+     */
+    bool accepted;
+
+    /**
+     * \brief The large file this segment belongs to, 0 for normal downloads
+     */
+    ROASegmentedDownload *segmented;
+
+    /**
+     * \brief Index of the segment in the large file
+     */
+    int segment;
+
+    /**
+     * \brief The content of the download
+     */
+    ROADownloadType type;
+
+    /**
+     * \brief Decompressor for compressed files, 0 if the file is sent as it is
+     */
+    ROADecompressor *decompressor;
+
+    /**
+     * \brief Extractor of bundles, the data is not written to a file
+     */
+    ROATarExtractor *extractor;
+};
+
+/**
+ * \brief File list entry to verify and the result of the verification
+ */
+struct ROAVerifyJob
+{
+    /**
+     * \brief The file, relative to the installation path
+     */
+    QString file;
+
+    /**
+     * \brief The expected SHA-256 as hex string
+     */
+    QString hash;
+
+    /**
+     * \brief The file size from the file list, -1 if unknown
+     */
+    qint64 size;
+
+    /**
+     * \brief Hashes of previous releases a binary patch is available for
+     */
+    QStringList patches;
+
+    /**
+     * \brief Hash of the local file, empty if it is missing or the cached hash was trusted
+     */
+    QString localHash;
+
+    /**
+     * \brief Suffix of the compressed file on the server, empty if it is not compressed
+     */
+    QString compression;
+
+    /**
+     * \brief Hash of the chunk index on the server, empty if there is none
+     */
+    QString chunkIndex;
+
+    /**
+     * \brief True if the file exists and the hash matches
+     */
+    bool valid;
+
+    /**
+     * \brief Amount of bytes hashed, 0 if the cached hash was trusted
+     */
+    qint64 bytes;
+
+    /**
+     * \brief Status of the file for the hash cache
+     */
+    ROAHashCacheEntry status;
+
+    /**
+     * \brief False if the file changed while it was hashed, the status then must not be cached
+     */
+    bool cacheable;
+};
+
+/**
+ * \brief Functor verifying file list entries on the worker threads
+ */
+class ROAFileVerifier
+{
+    public:
+
+        typedef ROAVerifyJob result_type;
+
+        /**
+         * \brief Constructor
+         * \param _path The installation path
+         * \param _cache The hash cache entries, empty to hash all files
+         * \param _trace The trace for the verify spans, 0 if not tracing
+         */
+        ROAFileVerifier(QString _path, const QHash<QString, ROAHashCacheEntry> &_cache, ROATrace *_trace);
+
+        /**
+         * \brief Verify a file list entry
+         * \param _job The entry to verify
+         * \return The entry with the result of the verification
+         */
+        ROAVerifyJob operator()(const ROAVerifyJob &_job);
+
+    private:
+
+        /**
+         * \brief The installation path
+         */
+        QString installationPath;
+
+        /**
+         * \brief Read only snapshot of the hash cache
+         */
+        QHash<QString, ROAHashCacheEntry> cache;
+
+        /**
+         * \brief The trace, 0 if not tracing
+         */
+        ROATrace *trace;
+
+        /**
+         * \brief Compare the file with the hash cache or hash it
+         * \param _job The entry to verify
+         * \return The entry with the result of the verification
+         */
+        ROAVerifyJob verify(const ROAVerifyJob &_job);
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+/**
+ * \brief Maps the file list entries on the thread pool of the engine
+ *
+ * QtConcurrent::mapped of Qt 5 always uses the global thread pool, which belongs to the application.
+ */
+class ROAVerifyKernel : public QtConcurrent::MappedEachKernel<QList<ROAVerifyJob>::const_iterator, ROAFileVerifier>
+{
+    public:
+
+        /**
+         * \brief Constructor
+         * \param _jobs The entries to verify, the list must not change until the verification finished
+         * \param _verifier The verifier called for each entry
+         * \param _pool The thread pool running the verifier
+         */
+        ROAVerifyKernel(const QList<ROAVerifyJob> &_jobs, ROAFileVerifier _verifier, QThreadPool *_pool);
+};
+#endif
+
+/**
+ * \brief Callbacks for programs using the engine without signals and slots
+ *
+ * All methods are called on the thread of the engine, the default implementations do nothing.
+ */
+class ROAEngineListener
+{
+    public:
+
+        /**
+         * \brief Deconstructor
+         */
+        virtual ~ROAEngineListener() {}
+
+        /**
+         * \brief Called in a fixed interval while verifying and downloading
+         * \param _done Bytes of the finished files and the received part of the running ones
+         * \param _total Size of all files to download
+         * \param _throughput Smoothed download speed in bytes per second
+         * \param _remaining Estimated remaining seconds, -1 if unknown
+         */
+        virtual void progress(qint64 _done, qint64 _total, double _throughput, qint64 _remaining)
+        {
+            Q_UNUSED(_done);
+            Q_UNUSED(_total);
+            Q_UNUSED(_throughput);
+            Q_UNUSED(_remaining);
+        }
+
+        /**
+         * \brief Called when the engine enters the next phase
+         * \param _phase manifest, verify, download or done
+         */
+        virtual void phaseChanged(QString _phase)
+        {
+            Q_UNUSED(_phase);
+        }
+
+        /**
+         * \brief Called for each verified file list entry
+         * \param _file The file, relative to the installation path
+         * \param _valid True if the file is up to date
+         * \param _hashedBytes Amount of bytes hashed, 0 if the cached hash was trusted
+         */
+        virtual void fileVerified(QString _file, bool _valid, qint64 _hashedBytes)
+        {
+            Q_UNUSED(_file);
+            Q_UNUSED(_valid);
+            Q_UNUSED(_hashedBytes);
+        }
+
+        /**
+         * \brief Called when the download of a file starts
+         * \param _file The file, relative to the installation path
+         */
+        virtual void fileStarted(QString _file)
+        {
+            Q_UNUSED(_file);
+        }
+
+        /**
+         * \brief Called when a file is installed or given up
+         * \param _file The file, relative to the installation path
+         * \param _success True if the file was installed
+         * \param _bytes Bytes received for the file
+         * \param _duration Time since the start of the download in ms
+         */
+        virtual void fileFinished(QString _file, bool _success, qint64 _bytes, qint64 _duration)
+        {
+            Q_UNUSED(_file);
+            Q_UNUSED(_success);
+            Q_UNUSED(_bytes);
+            Q_UNUSED(_duration);
+        }
+
+        /**
+         * \brief Called on problems the user should know about
+         * \param _message The description of the problem
+         */
+        virtual void error(QString _message)
+        {
+            Q_UNUSED(_message);
+        }
+
+        /**
+         * \brief Called before finished when a run completed
+         * \param _metrics Time, bytes and throughput of the phases and the counters of the run, see ROAMetrics::getValues
+         */
+        virtual void metricsReported(const QMap<QString, double> &_metrics)
+        {
+            Q_UNUSED(_metrics);
+        }
+
+        /**
+         * \brief Called when all files are verified and downloaded
+         * \param _success False if the run was stopped, the reason was reported as error before
+         * \param _failedFiles Files which could not be downloaded
+         */
+        virtual void finished(bool _success, const QStringList &_failedFiles)
+        {
+            Q_UNUSED(_success);
+            Q_UNUSED(_failedFiles);
+        }
+
+        /**
+         * \brief Called when the installation was removed
+         * \param _success False if files are left
+         */
+        virtual void uninstallFinished(bool _success)
+        {
+            Q_UNUSED(_success);
+        }
+};
+
+/**
+ * \brief Downloads and verifies the files of the file list
+ *
+ * The engine lives on its own thread, it only talks to the user interface with signals
+ * or the callbacks of a listener. All calls from other threads have to be queued.
+ * It is built as the roaengine library, see roaengine.pri for using it in other projects.
+ */
+class ROAEngine : public QObject
+{
+        Q_OBJECT
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         * \param parent The parent
+         */
+        explicit ROAEngine(QObject *parent = 0);
+
+        /**
+         * \brief Deconstuctor
+         */
+        ~ROAEngine();
+
+        /**
+         * \brief Add callbacks, use it before starting the engine
+         * \param _listener The callbacks, the engine does not take ownership
+         */
+        void addListener(ROAEngineListener *_listener);
+
+        /**
+         * \brief Write the metrics of each run for the Prometheus textfile collector, use it before starting the engine
+         * \param _fileName The file, should end with .prom, empty to use the metricsFile setting
+         */
+        void setMetricsFile(QString _fileName);
+
+        /**
+         * \brief Trace each run in the Chrome trace event format, use it before starting the engine
+         * \param _fileName The trace file, empty to disable tracing
+         */
+        void setTraceFile(QString _fileName);
+
+        /**
+         * \brief Download from another server, e.g. a mirror or a local test server, use it before starting the engine
+         * \param _url The url of the data directory containing the platform directories, empty to use the baseUrl setting
+         */
+        void setBaseUrl(QString _url);
+
+        /**
+         * \brief Get the throughput of the file verification
+         * \return The hashed MB per second, 0 if nothing was hashed yet
+         */
+        double getHashThroughput();
+
+        /**
+         * \brief Check file with SHA-256, the file is read in chunks to keep the memory usage constant
+         *
+         * This is thread safe, every thread uses its own buffer.
+         *
+         * \param _file The absolute path of the file to check
+         * \param _hash The expected hash as hex string
+         * \param _hashedBytes If set, receives the amount of bytes hashed
+         * \param _localHash If set, receives the hash of the file
+         * \return True if the file exists and the hash matches
+         */
+        static bool checkFileWithHash(QString _file, QString _hash, qint64 *_hashedBytes = 0, QString *_localHash = 0);
+
+        /**
+         * \brief Remove a dir with all its content
+         *
+         * \param _dir The directory to remove
+         */
+        static bool removeDirWithContent(QString _dir);
+
+        /**
+         * \brief Read the file list
+         *
+         * Format: file;hash[;size[;patches[;compression[;chunks]]]]
+         * Patches is a comma separated list of old hashes, compression the suffix of the compressed file (zst or gz)
+         * Chunks is the hash of the chunk index of the file
+         *
+         * Bundles: bundle;directory
+         * The server has a tar.zst with all files of the directory next to it,
+         * its members are named with their full path relative to the installation path (ustar, no pax or GNU headers)
+         *
+         * The file is mapped and split with ROAFileListParser, only the entries are copied.
+         *
+         * \param _fileName The file list
+         * \param _jobs Receives the entries to verify
+         * \param _bundles Receives the directories with a bundle
+         * \return False if the file list could not be opened
+         */
+        static bool parseFileList(QString _fileName, QList<ROAVerifyJob> *_jobs, QStringList *_bundles);
+
+    public slots:
+
+        /**
+         * \brief Verify the installation and download broken or missing files
+         * \param _installationPath The installation path with ending slash
+         * \param _mode The installation mode (default, update, verify or repair)
+         * \param _deep True to ignore the hash cache and hash all files
+         */
+        void start(QString _installationPath, QString _mode, bool _deep);
+
+        /**
+         * \brief Remove the installation
+         * \param _installationPath The installation path with ending slash
+         */
+        void uninstall(QString _installationPath);
+
+    signals:
+
+        /**
+         * \brief Emitted in a fixed interval while downloading
+         * \param _percent The progress in percent
+         * \param _text Current file, throughput and remaining time
+         */
+        void progressChanged(int _percent, QString _text);
+
+        /**
+         * \brief Emitted on problems the user should know about
+         * \param _message The description of the problem
+         */
+        void errorOccurred(QString _message);
+
+        /**
+         * \brief Emitted when all files are verified and downloaded
+         * \param _success False if the run was stopped, the reason was reported as error before
+         * \param _failedFiles Files which could not be downloaded
+         */
+        void finished(bool _success, QStringList _failedFiles);
+
+        /**
+         * \brief Emitted when the installation was removed
+         * \param _success False if files are left
+         */
+        void uninstallFinished(bool _success);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Callbacks of the embedding program
+         */
+        QList<ROAEngineListener*> listeners;
+
+        /**
+         * \brief Time since the engine was started
+         */
+        QElapsedTimer runTimer;
+
+        /**
+         * \brief Start of the running file downloads in ms since the engine was started
+         */
+        QHash<QString, qint64> fileStartTimes;
+
+        /**
+         * \brief Wall time, bytes and files of the phases
+         */
+        ROAMetrics metrics;
+
+        /**
+         * \brief Prometheus textfile for the metrics, empty if not wanted
+         */
+        QString metricsFile;
+
+        /**
+         * \brief Trace file of the runs, empty if not wanted
+         */
+        QString traceFile;
+
+        /**
+         * \brief Url of the data directory on the server with ending slash
+         */
+        QString baseUrl;
+
+        /**
+         * \brief The trace of the running run, 0 if not tracing
+         */
+        ROATrace *trace;
+
+        /**
+         * \brief Traced requests which did not receive their headers yet
+         */
+        QSet<QNetworkReply*> waitingRequests;
+
+        /**
+         * \brief Network manager for downloading files
+         */
+        QNetworkAccessManager manager;
+
+        /**
+         * \brief SSL config for custom CAs
+         */
+        QSslConfiguration sslConfig;
+
+        /**
+         * \brief Custom CAs
+         */
+        QList<QSslCertificate> certificates;
+
+        /**
+         * \brief Request for downloading
+         */
+        QNetworkRequest request;
+
+        /**
+         * \brief Installation path
+         */
+        QString installationPath;
+
+        /**
+         * \brief File list to download
+         */
+        QStringList fileList;
+
+        /**
+         * \brief SHA-256 of files for verifying the downloads
+         */
+        QStringList fileListMD5;
+
+        /**
+         * \brief Sizes of the files to download, -1 if unknown
+         */
+        QList<qint64> fileListSize;
+
+        /**
+         * \brief Hash of the local file a binary patch is downloaded for, empty for a full download
+         */
+        QStringList fileListPatch;
+
+        /**
+         * \brief Suffix of the compressed files on the server, empty if not compressed
+         */
+        QStringList fileListCompression;
+
+        /**
+         * \brief Hash of the chunk indexes on the server, empty if the file is not chunked
+         */
+        QStringList fileListChunks;
+
+        /**
+         * \brief Chunks of the installed files
+         */
+        ROAChunkStore chunkStore;
+
+        /**
+         * \brief Directories with a bundle of all their files on the server
+         */
+        QStringList bundles;
+
+        /**
+         * \brief Broken or missing files of the bundles, mapped to the bundle directory
+         */
+        QHash<QString, QList<ROAVerifyJob> > bundleMissing;
+
+        /**
+         * \brief Minimum amount of missing files to download a bundle instead of the single files
+         */
+        int bundleThreshold;
+
+        /**
+         * \brief Chunks waiting for a free download slot
+         */
+        QList<ROAChunkRequest> chunkQueue;
+
+        /**
+         * \brief Running chunk downloads mapped to their reply
+         */
+        QHash<QNetworkReply*, ROAChunkRequest> chunkDownloads;
+
+        /**
+         * \brief Files which could not be assembled from chunks, waiting for a free slot to be downloaded in full
+         */
+        QList<int> fallbackQueue;
+
+        /**
+         * \brief The chunk index hashes of the file list entries mapped to their file
+         */
+        QHash<QString, QString> chunkIndexes;
+
+        /**
+         * \brief Chunk indexes of installed files waiting for a free download slot
+         */
+        QList<ROAChunkIndexRequest> indexQueue;
+
+        /**
+         * \brief Running chunk index downloads mapped to their reply
+         */
+        QHash<QNetworkReply*, ROAChunkIndexRequest> indexDownloads;
+
+        /**
+         * \brief The user settings
+         */
+        QSettings *userSettings;
+
+        /**
+         * \brief Installation mode
+         */
+        QString installationMode;
+
+        /**
+         * \brief Current download phase (0 init, 1 file download)
+         */
+        int downloadPhase;
+
+        /**
+         * \brief Files left to download, files already requested are not counted
+         */
+        int filesLeft;
+
+        /**
+         * \brief Maximal amount of downloads running at the same time
+         */
+        int maxParallelDownloads;
+
+        /**
+         * \brief True if HTTP/2 may be used, the requests are then multiplexed over one connection
+         */
+        bool http2;
+
+        /**
+         * \brief Amount of finished requests
+         */
+        int requestCount;
+
+        /**
+         * \brief Amount of TLS handshakes, each new encrypted connection does one
+         *
+         * Qt reports no new plain HTTP connections, e.g. to roamockcdn, they are not counted.
+         */
+        int tlsHandshakes;
+
+        /**
+         * \brief Amount of responses received over TLS, 0 handshakes only mean full reuse if this is not 0
+         */
+        int encryptedResponses;
+
+        /**
+         * \brief Amount of responses received over HTTP/2
+         */
+        int http2Responses;
+
+        /**
+         * \brief Files of this size or larger are downloaded in segments
+         */
+        qint64 segmentThreshold;
+
+        /**
+         * \brief Amount of segments a large file is split into
+         */
+        int segmentCount;
+
+        /**
+         * \brief Segments waiting for a free download slot
+         */
+        QList<ROASegmentRequest> segmentQueue;
+
+        /**
+         * \brief Running downloads mapped to their reply
+         */
+        QHash<QNetworkReply*, ROADownload> activeDownloads;
+
+        /**
+         * \brief Reusable buffer for moving received data to the disk
+         */
+        QByteArray downloadBuffer;
+
+        /**
+         * \brief Files which could not be downloaded correctly
+         */
+        QStringList failedFiles;
+
+        /**
+         * \brief Amount of bytes hashed during the verification
+         */
+        qint64 hashedBytes;
+
+        /**
+         * \brief Duration of the verification in nanoseconds
+         */
+        qint64 hashingTime;
+
+        /**
+         * \brief Timer for the duration of the verification
+         */
+        QElapsedTimer verifyTimer;
+
+        /**
+         * \brief Threads verifying the file list entries, the global thread pool is left to the application
+         */
+        QThreadPool verifyPool;
+
+        /**
+         * \brief The entries being verified
+         */
+        QList<ROAVerifyJob> verifyJobs;
+
+        /**
+         * \brief Watcher for the verification running on the thread pool
+         */
+        QFutureWatcher<ROAVerifyJob> verifyWatcher;
+
+        /**
+         * \brief True until all verification results are handled, more files can be queued meanwhile
+         */
+        bool verifyRunning;
+
+        /**
+         * \brief Progress of the downloads in bytes
+         */
+        ROAProgress progress;
+
+        /**
+         * \brief Reports the progress in a fixed interval instead of on every event
+         */
+        QTimer progressTimer;
+
+        /**
+         * \brief The file last requested, part of the progress text
+         */
+        QString currentFile;
+
+        /**
+         * \brief Verified hashes of unchanged files
+         */
+        ROAHashCache hashCache;
+
+        /**
+         * \brief Ignore the hash cache and hash all files
+         */
+        bool deepVerify;
+
+        /**
+         * \brief SHA-256 of the downloaded file list, empty if the download failed
+         */
+        QString manifestHash;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Check if neded dirs are existing, if not create them
+         */
+        void checkDirectories();
+
+        /**
+         * \brief Get file list from remote server
+         */
+        void getRemoteFileList();
+
+        /**
+         * \brief Prepare the download, the file list entries are verified on the thread pool
+         *
+         * Files failing the verification are downloaded while the other entries are still checked.
+         */
+        void prepareDownload();
+
+        /**
+         * \brief Read the file list of the installed release
+         * \param _hash Receives the SHA-256 of the installed file list
+         * \return The hashes mapped to the files
+         */
+        QHash<QString, QString> loadInstalledManifest(QString *_hash);
+
+        /**
+         * \brief Remember the downloaded file list as installed release
+         */
+        void saveInstalledManifest();
+
+        /**
+         * \brief Download the next files in queue until all download slots are used
+         */
+        void getNextFile();
+
+        /**
+         * \brief Get the url of a file on the server
+         * \param _file The file, relative to the platform directory
+         * \return The url
+         */
+        QUrl getFileUrl(QString _file);
+
+        /**
+         * \brief Get the directory of the platform on the server
+         * \return The directory, e.g. linux_x86_64
+         */
+        static QString getPlatform();
+
+        /**
+         * \brief Request the current url and stream the data into a temporary file
+         *
+         * If a partial file with a validator from an earlier attempt exists, only the missing range is requested.
+         * Compressed files are decompressed on the way to the disk, they are not resumed.
+         *
+         * \param _fileName The file to write, relative to the installation path
+         * \param _index The index in the file list, -1 for the file list itself
+         * \param _attempt The number of the download attempt
+         * \param _type The content of the download
+         */
+        void startDownload(QString _fileName, int _index, int _attempt = 1, ROADownloadType _type = ROADownloadFile);
+
+        /**
+         * \brief Download a whole file, compressed, in segments or as it is
+         * \param _index The index in the file list
+         */
+        void startFullDownload(int _index);
+
+        /**
+         * \brief Add a broken or missing file to the download queue
+         * \param _job The verified file list entry
+         */
+        void queueFile(const ROAVerifyJob &_job);
+
+        /**
+         * \brief Download the bundle of a directory and extract the missing files while downloading
+         * \param _directory The bundle directory, relative to the installation path
+         */
+        void startBundleDownload(QString _directory);
+
+        /**
+         * \brief Write the received data of a bundle to the extractor
+         * \param _reply The reply of the bundle
+         * \param _download The state of the bundle download
+         */
+        void writeBundleData(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Install the extracted files of a bundle, the others are downloaded on their own
+         * \param _reply The reply of the bundle
+         * \param _download The state of the bundle download
+         */
+        void finishBundle(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Assemble a file from its downloaded chunk index
+         *
+         * Chunks available in installed files are copied, the others are queued for downloading.
+         *
+         * \param _index The index in the file list
+         * \return False if the chunk index is broken
+         */
+        bool assembleChunkedFile(int _index);
+
+        /**
+         * \brief Request a missing chunk
+         * \param _request The chunk to download
+         */
+        void startChunk(const ROAChunkRequest &_request);
+
+        /**
+         * \brief Verify a downloaded chunk and write it at all its offsets
+         * \param _reply The finished reply
+         */
+        void finishChunk(QNetworkReply *_reply);
+
+        /**
+         * \brief Verify an assembled file and move it into place, on failure the whole file is downloaded
+         * \param _download The assembled file
+         */
+        void finishChunkedDownload(ROAChunkedDownload *_download);
+
+        /**
+         * \brief Queue the chunk index of an installed file if the file list has one and its chunks are not known
+         * \param _file The file, relative to the installation path
+         */
+        void queueChunkIndex(QString _file);
+
+        /**
+         * \brief Request the chunk index of an installed file
+         * \param _request The chunk index to download
+         */
+        void startChunkIndex(const ROAChunkIndexRequest &_request);
+
+        /**
+         * \brief Verify a downloaded chunk index and remember the chunks of its file
+         * \param _reply The finished reply
+         */
+        void finishChunkIndex(QNetworkReply *_reply);
+
+        /**
+         * \brief Get the amount of requests using a download slot
+         * \return Running file, segment, chunk and chunk index downloads
+         */
+        int getRunningRequests() const;
+
+        /**
+         * \brief Apply a downloaded binary patch to the local file
+         *
+         * The patch is a zstd frame compressed with the old file as prefix (zstd --patch-from).
+         * The result is hashed while writing and only moved into place if it matches the file list.
+         *
+         * \param _index The index in the file list
+         * \return True if the patched file was verified and moved into place
+         */
+        bool applyPatch(int _index);
+
+        /**
+         * \brief Check the response headers, restart the file if the server sent the whole file and store the validator
+         * \param _reply The reply to check
+         * \param _download The download the reply belongs to
+         */
+        void handleDownloadHeaders(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Move the data received so far from the reply into the file and hash it
+         * \param _reply The reply to read from
+         * \param _download The download the data belongs to
+         */
+        void writeDownloadData(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Download a large file in several byte ranges at the same time
+         * \param _fileName The file to write, relative to the installation path
+         * \param _index The index in the file list
+         */
+        void startSegmentedDownload(QString _fileName, int _index);
+
+        /**
+         * \brief Request the missing data of a segment
+         * \param _segmented The large file
+         * \param _segment The index of the segment
+         */
+        void startSegment(ROASegmentedDownload *_segmented, int _segment);
+
+        /**
+         * \brief Write the data received so far for a segment at its offset
+         * \param _reply The reply to read from
+         * \param _download The download of the segment
+         */
+        void writeSegmentData(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Check if a partial response contains the requested range
+         * \param _reply The reply with status 206
+         * \param _segment The requested segment
+         * \return True if the Content-Range header starts at the position of the segment and ends within it
+         */
+        static bool checkContentRange(QNetworkReply *_reply, const ROASegment &_segment);
+
+        /**
+         * \brief Stop all segments of a large file, it falls back to a single stream
+         * \param _segmented The large file
+         */
+        void cancelSegments(ROASegmentedDownload *_segmented);
+
+        /**
+         * \brief Add the data available in order to the hash of a large file
+         * \param _segmented The large file
+         */
+        void updateSegmentedHash(ROASegmentedDownload *_segmented);
+
+        /**
+         * \brief Handle a finished segment, the file is verified when the last segment is done
+         * \param _reply The finished reply
+         * \param _download The download of the segment
+         */
+        void finishSegment(QNetworkReply *_reply, ROADownload &_download);
+
+        /**
+         * \brief Verify and install a large file after its last segment, falls back to a single stream on errors
+         * \param _segmented The large file, it is deleted
+         */
+        void completeSegmentedDownload(ROASegmentedDownload *_segmented);
+
+        /**
+         * \brief Move a verified temporary file into place and remember its hash
+         * \param _fileName The file, relative to the installation path
+         * \param _hash The verified hash for the hash cache, empty for the file list itself
+         * \param _suffix Suffix of the temporary file next to the file
+         * \return True if the file was replaced
+         */
+        bool installDownloadedFile(QString _fileName, QString _hash, QString _suffix = ".part");
+
+        /**
+         * \brief Move a finished download to its final place if it is valid
+         * \param _reply The finished reply
+         * \param _download The download to check
+         * \return True if the file was replaced, false if the data was broken
+         */
+        bool commitDownload(QNetworkReply *_reply, const ROADownload &_download);
+
+        /**
+         * \brief Tell the listeners about the next phase
+         * \param _phase manifest, verify, download or done
+         */
+        void setPhase(QString _phase);
+
+        /**
+         * \brief Stop the run, report the reason and finish without success
+         * \param _message The reason for the user
+         */
+        void stopRun(QString _message);
+
+        /**
+         * \brief Remember the start of a file download and tell the listeners
+         * \param _file The file, relative to the installation path
+         */
+        void startFile(QString _file);
+
+        /**
+         * \brief Count a file as done and tell the listeners
+         * \param _file The file, relative to the installation path
+         * \param _success True if the file was installed
+         */
+        void finishFile(QString _file, bool _success);
+
+        /**
+         * \brief Get the start of a span
+         * \return The time of the trace, 0 if not tracing
+         */
+        qint64 traceTime();
+
+        /**
+         * \brief Trace a span of the engine thread which ends now
+         * \param _name The name of the span
+         * \param _start The start from traceTime()
+         * \param _file The file the span belongs to
+         */
+        void traceSpan(QString _name, qint64 _start, QString _file);
+
+        /**
+         * \brief Trace a request until its first byte and until it is finished
+         * \param _reply The reply of the request
+         */
+        void traceRequest(QNetworkReply *_reply);
+
+    private slots:
+
+        /**
+         * \brief Saves the file when download finished
+         * \param reply The data of the downloaded file
+         */
+        void slot_downloadFinished(QNetworkReply *reply);
+
+        /**
+         * \brief Writes the received data of a running download to the disk
+         */
+        void slot_downloadReadyRead();
+
+        /**
+         * \brief Downloads a file list entry right away if the verification failed
+         * \param _index The index of the result
+         */
+        void slot_verifyResultReady(int _index);
+
+        /**
+         * \brief Finishes the verification, the process is done when the last download is finished
+         */
+        void slot_verifyFinished();
+
+        /**
+         * \brief Reports the progress, throughput and remaining time
+         */
+        void slot_updateProgress();
+
+        /**
+         * \brief Checks for SSL errors
+         * \param reply The reply
+         * \param errors Error list
+         */
+        void slot_getSSLError(QNetworkReply* reply, const QList<QSslError> &errors);
+
+        /**
+         * \brief Counts the TLS handshakes of new connections
+         * \param reply The reply the connection was opened for
+         */
+        void slot_encrypted(QNetworkReply* reply);
+
+        /**
+         * \brief Ends the first byte span of a traced request when its headers arrive
+         */
+        void slot_traceFirstByte();
+};
+
+#endif // ROAENGINE_H
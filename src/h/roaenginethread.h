@@ -0,0 +1,115 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Thread running the engine for a frontend
+ *
+ * \file    	roaenginethread.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAENGINETHREAD_H
+#define ROAENGINETHREAD_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QObject>
+#include <QThread>
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+#include "../h/roaengine.h"
+
+/**
+ * \brief Owns the engine and the thread it lives on
+ *
+ * Hashing and writing files does not block the thread of the frontend, all communication is queued.
+ * The engine is deleted on its thread when the thread object is destroyed.
+ */
+class ROAEngineThread : public QThread
+{
+        Q_OBJECT
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor, creates the engine and moves it to the thread
+         * \param parent The parent
+         */
+        explicit ROAEngineThread(QObject *parent = 0);
+
+        /**
+         * \brief Deconstuctor, lets the engine finish its events and waits for the thread
+         */
+        ~ROAEngineThread();
+
+        /**
+         * \brief Get the engine, only call methods which are documented as usable before starting it
+         * \return The engine
+         */
+        ROAEngine *getEngine() const;
+
+        /**
+         * \brief Connect a frontend and start the thread
+         *
+         * The frontend needs the signals startEngine(QString, QString, bool) and startUninstall(QString)
+         * and the slots slot_engineProgress(int, QString), slot_engineError(QString),
+         * slot_engineFinished(bool, QStringList) and slot_uninstallFinished(bool).
+         *
+         * \param _frontend The frontend
+         */
+        void startFor(QObject *_frontend);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The engine, it lives on this thread
+         */
+        ROAEngine *engine;
+};
+
+#endif // ROAENGINETHREAD_H
@@ -0,0 +1,168 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Machine readable event stream of the engine
+ *
+ * \file    	roaeventwriter.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAEVENTWRITER_H
+#define ROAEVENTWRITER_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+
+/******************************************************************************/
+/*                                                                            */
+/*    Others includes                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+#include "../h/roaengine.h"
+
+/**
+ * \brief Writes the events of the engine as JSON lines
+ *
+ * Every line is an object with the name of the event and the time in ms since the writer was created.
+ * Events: phase, verified, fileStarted, fileFinished, progress (once per second), error, metrics, summary and uninstall.
+ * The target is a file, a named pipe or stdout.
+ */
+class ROAEventWriter : public ROAEngineListener
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor, opens the target
+         * \param _target The file or named pipe to write to, - for stdout
+         */
+        ROAEventWriter(QString _target);
+
+        /**
+         * \brief Check if the target could be opened
+         * \return True if the events are written
+         */
+        bool isOpen() const;
+
+        void phaseChanged(QString _phase);
+        void fileVerified(QString _file, bool _valid, qint64 _hashedBytes);
+        void fileStarted(QString _file);
+        void fileFinished(QString _file, bool _success, qint64 _bytes, qint64 _duration);
+        void progress(qint64 _done, qint64 _total, double _throughput, qint64 _remaining);
+        void error(QString _message);
+        void metricsReported(const QMap<QString, double> &_metrics);
+        void finished(bool _success, const QStringList &_failedFiles);
+        void uninstallFinished(bool _success);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The target
+         */
+        QFile file;
+
+        /**
+         * \brief Time since the writer was created
+         */
+        QElapsedTimer timer;
+
+        /**
+         * \brief Time of the last progress event in ms
+         */
+        qint64 lastProgress;
+
+        /**
+         * \brief Amount of verified files
+         */
+        int verifiedFiles;
+
+        /**
+         * \brief Amount of verified files which were up to date
+         */
+        int validFiles;
+
+        /**
+         * \brief Bytes hashed during the verification
+         */
+        qint64 hashedBytes;
+
+        /**
+         * \brief Amount of installed files
+         */
+        int downloadedFiles;
+
+        /**
+         * \brief Amount of files given up
+         */
+        int failedFiles;
+
+        /**
+         * \brief Bytes received for the finished files
+         */
+        qint64 receivedBytes;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Write an event as a single line
+         * \param _event The name of the event
+         * \param _data The fields of the event
+         */
+        void write(QString _event, QJsonObject _data);
+};
+
+#endif // ROAEVENTWRITER_H
@@ -0,0 +1,183 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Reads the file list without copying it
+ *
+ * \file    	roafilelistparser.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAFILELISTPARSER_H
+#define ROAFILELISTPARSER_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QByteArray>
+
+/**
+ * \brief Part of the file list, only valid as long as the data of the parser
+ */
+struct ROAByteView
+{
+    /**
+     * \brief First byte
+     */
+    const char *data;
+
+    /**
+     * \brief Amount of bytes
+     */
+    int size;
+
+    /**
+     * \brief Check for an empty field
+     * \return True if the field is empty or missing
+     */
+    bool isEmpty() const
+    {
+        return size == 0;
+    }
+
+    /**
+     * \brief Copy the field
+     * \return The UTF-8 decoded field
+     */
+    QString toString() const
+    {
+        return QString::fromUtf8(data, size);
+    }
+};
+
+/**
+ * \brief A line of the file list
+ *
+ * Format: file;hash[;size[;patches[;compression[;chunks]]]]
+ * Bundles: bundle;directory, the directory is in file
+ * Missing fields are empty.
+ */
+struct ROAFileListEntry
+{
+    /**
+     * \brief True for bundle lines
+     */
+    bool bundle;
+
+    /**
+     * \brief The file, relative to the installation path
+     */
+    ROAByteView file;
+
+    /**
+     * \brief SHA-256 as hex string
+     */
+    ROAByteView hash;
+
+    /**
+     * \brief Size in bytes, empty if unknown
+     */
+    ROAByteView size;
+
+    /**
+     * \brief Comma separated hashes of the releases with a patch
+     */
+    ROAByteView patches;
+
+    /**
+     * \brief Suffix of the compressed file
+     */
+    ROAByteView compression;
+
+    /**
+     * \brief Hash of the chunk index
+     */
+    ROAByteView chunks;
+};
+
+/**
+ * \brief Splits the file list into entries without allocating memory
+ *
+ * The entries point into the data, which is not copied. It can be a mapped file.
+ * Invalid lines are skipped, like empty lines or lines with too many fields.
+ */
+class ROAFileListParser
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         * \param _data The file list, it has to stay valid while parsing
+         * \param _size Size of the data
+         */
+        ROAFileListParser(const char *_data, qint64 _size);
+
+        /**
+         * \brief Read the next valid line
+         * \param _entry Receives the entry
+         * \return False at the end of the data
+         */
+        bool next(ROAFileListEntry *_entry);
+
+        /**
+         * \brief Read a number
+         * \param _view The field
+         * \return The number, -1 if the field is empty or not a number
+         */
+        static qint64 toNumber(ROAByteView _view);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Start of the next line
+         */
+        const char *position;
+
+        /**
+         * \brief End of the data
+         */
+        const char *end;
+};
+
+#endif // ROAFILELISTPARSER_H
@@ -0,0 +1,172 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Cache of verified file hashes keyed by the file status
+ *
+ * \file    	roahashcache.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAHASHCACHE_H
+#define ROAHASHCACHE_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+
+/**
+ * \brief Status of a file and its verified hash
+ */
+struct ROAHashCacheEntry
+{
+    /**
+     * \brief File size in bytes
+     */
+    qint64 size;
+
+    /**
+     * \brief Last modification in milliseconds since epoch
+     */
+    qint64 modified;
+
+    /**
+     * \brief Inode of the file, 0 where not supported
+     */
+    quint64 inode;
+
+    /**
+     * \brief The verified SHA-256 as hex string
+     */
+    QString hash;
+};
+
+/**
+ * \brief Remembers verified hashes, a file is trusted as long as its status is unchanged
+ */
+class ROAHashCache
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         */
+        ROAHashCache();
+
+        /**
+         * \brief Load the cache, entries in memory are replaced
+         * \param _file The cache file
+         * \return True if the file was read
+         */
+        bool load(QString _file);
+
+        /**
+         * \brief Save the cache to the file it was loaded from
+         * \return True if the file was written
+         */
+        bool save();
+
+        /**
+         * \brief Get all entries, used as read only snapshot by the verification threads
+         * \return The entries mapped to their path relative to the installation path
+         */
+        QHash<QString, ROAHashCacheEntry> getEntries() const;
+
+        /**
+         * \brief Add or replace an entry
+         * \param _path The path relative to the installation path
+         * \param _entry The entry
+         */
+        void insert(QString _path, const ROAHashCacheEntry &_entry);
+
+        /**
+         * \brief Remove an entry
+         * \param _path The path relative to the installation path
+         */
+        void remove(QString _path);
+
+        /**
+         * \brief Read the status of a file
+         * \param _file The absolute path of the file
+         * \param _entry Receives the status, the hash is not touched
+         * \return True if the file exists
+         */
+        static bool readStatus(QString _file, ROAHashCacheEntry *_entry);
+
+        /**
+         * \brief Compare two status of the same file
+         * \param _before The earlier status
+         * \param _after The later status
+         * \return True if size, modification time and inode are the same
+         */
+        static bool isUnchanged(const ROAHashCacheEntry &_before, const ROAHashCacheEntry &_after);
+
+        /**
+         * \brief Check if a cached entry can be trusted
+         * \param _cached The cached entry
+         * \param _current The current status of the file
+         * \param _hash The expected hash
+         * \return True if the status is unchanged and the hash matches
+         */
+        static bool isValid(const ROAHashCacheEntry &_cached, const ROAHashCacheEntry &_current, QString _hash);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The cache file
+         */
+        QString fileName;
+
+        /**
+         * \brief The entries mapped to their path relative to the installation path
+         */
+        QHash<QString, ROAHashCacheEntry> entries;
+};
+
+#endif // ROAHASHCACHE_H
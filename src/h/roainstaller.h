@@ -43,16 +43,13 @@
 /*                                                                            */
 /******************************************************************************/
 #include <QObject>
+#include <QApplication>
 #include <QSettings>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QSslConfiguration>
-#include <QtNetwork/QNetworkRequest>
-#include <QtNetwork/QNetworkReply>
-#include <QtNetwork/QSslError>
 #include <QStandardPaths>
 #include <QFile>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QTimer>
 
 
 /******************************************************************************/
@@ -62,14 +59,17 @@
 /******************************************************************************/
 
 #include "../h/roamainwidget.h"
+#include "../h/roaengine.h"
+#include "../h/roaenginethread.h"
 
 #ifdef Q_OS_WIN
 #include "../h/windowsprocess.h"
 #endif
 
-
 /**
  * \brief Installer logic for the Relics of Annorath Launcher and game files
+ *
+ * Handles the user interface, the files are verified and downloaded by the engine on its own thread.
  */
 class ROAInstaller : public QObject
 {
@@ -124,49 +124,69 @@ class ROAInstaller : public QObject
          */
         void uninstall();
 
-    private:
+        /**
+         * \brief Ignore the hash cache and hash all files
+         * \param _deep True to hash all files
+         */
+        void setDeepVerify(bool _deep);
 
-        /******************************************************************************/
-        /*                                                                            */
-        /*    Members                                                                 */
-        /*                                                                            */
-        /******************************************************************************/
+        /**
+         * \brief Forward the callbacks of the engine, must be called before an installation mode starts
+         * \param _listener The callbacks, they are called on the engine thread
+         */
+        void addListener(ROAEngineListener *_listener);
 
         /**
-         * \brief Network manager for downloading files
+         * \brief Write the metrics of the run for the Prometheus textfile collector
+         * \param _fileName The file, should end with .prom
          */
-        QNetworkAccessManager manager;
+        void setMetricsFile(QString _fileName);
 
         /**
-         * \brief SSL config for custom CAs
+         * \brief Trace the run in the Chrome trace event format
+         * \param _fileName The trace file, empty to disable tracing
          */
-        QSslConfiguration sslConfig;
+        void setTraceFile(QString _fileName);
 
         /**
-         * \brief Custom CAs
+         * \brief Download from another server, e.g. a mirror or a local test server
+         * \param _url The url of the data directory, empty to use the baseUrl setting
          */
-        QList<QSslCertificate> certificates;
+        void setBaseUrl(QString _url);
+
+    signals:
 
         /**
-         * \brief Request for downloading
+         * \brief Start the engine on its thread
+         * \param _installationPath The installation path with ending slash
+         * \param _mode The installation mode
+         * \param _deep True to ignore the hash cache
          */
-        QNetworkRequest request;
+        void startEngine(QString _installationPath, QString _mode, bool _deep);
 
         /**
-         * \brief Installation path
+         * \brief Remove the installation on the engine thread
+         * \param _installationPath The installation path with ending slash
          */
-        QString installationPath;
+        void startUninstall(QString _installationPath);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
 
         /**
-         * \brief File list to download
+         * \brief Installation path
          */
-        QStringList fileList;
+        QString installationPath;
 
         /**
-         * \brief MD5 of files for verifying
-         * \todo This has no use atm
+         * \brief Last problem reported by the engine, shown if the run stops
          */
-        QStringList fileListMD5;
+        QString lastError;
 
         /**
          * \brief List of selected components to install
@@ -213,14 +233,19 @@ class ROAInstaller : public QObject
         int curPage;
 
         /**
-         * \brief Current download phase (0 init, 1 file download)
+         * \brief The engine, it lives on the engine thread
+         */
+        ROAEngine *engine;
+
+        /**
+         * \brief Thread of the engine, hashing and writing files does not block the user interface
          */
-        int downloadPhase;
+        ROAEngineThread engineThread;
 
         /**
-         * \brief Files left to download
+         * \brief Ignore the hash cache and hash all files
          */
-        int filesLeft;
+        bool deepVerify;
 
         /**
          * \brief Block mode, if a condition is to bad some actions are disabled (no installPath = we can't verify anything)
@@ -233,48 +258,16 @@ class ROAInstaller : public QObject
         /*                                                                            */
         /******************************************************************************/
 
-        /**
-         * \brief Remove a dir with all its content
-         *
-         * \param _dir The directory to remove
-         */
-        bool removeDirWithContent(QString _dir);
-
         /**
          * \brief Remove no longer needed files from previous releases
          */
         void cleanupObsoletFiles();
 
-        /**
-         * \brief Check if neded dirs are existing, if not create them
-         */
-        void checkDirectories();
-
-        /**
-         * \brief Get file list from remote server
-         */
-        void getRemoteFileList();
-
         /**
          * \brief Install optional components and create shortcuts
          */
         void installOptionalComponents();
 
-        /**
-         * \brief Prepare the download
-         */
-        void prepareDownload();
-
-        /**
-         * \brief Download the next file in queue
-         */
-        void getNextFile();
-
-        /**
-         * \brief Check file with md5
-         */
-        bool checkFileWithHash(QString _file, QString _hash);
-
 #ifdef Q_OS_LINUX
         /**
          * \brief Create linux shortcuts
@@ -296,17 +289,30 @@ class ROAInstaller : public QObject
     private slots:
 
         /**
-         * \brief Saves the file when download finished
-         * \param reply The data of the downloaded file
+         * \brief Shows the progress of the engine on the status page
+         * \param _percent The progress in percent
+         * \param _text Current file, throughput and remaining time
+         */
+        void slot_engineProgress(int _percent, QString _text);
+
+        /**
+         * \brief Shows problems reported by the engine
+         * \param _message The description of the problem
+         */
+        void slot_engineError(QString _message);
+
+        /**
+         * \brief Finishes the installation mode when the engine is done
+         * \param _success False if the run was stopped, the reason was reported before
+         * \param _failedFiles Files which could not be downloaded
          */
-        void slot_downloadFinished(QNetworkReply *reply);
+        void slot_engineFinished(bool _success, QStringList _failedFiles);
 
         /**
-         * \brief Checks for SSL errors
-         * \param reply The reply
-         * \param errors Error list
+         * \brief Shows the result of the uninstallation
+         * \param _success False if files are left
          */
-        void slot_getSSLError(QNetworkReply* reply, const QList<QSslError> &errors);
+        void slot_uninstallFinished(bool _success);
 
         /**
          * \brief Start installation process
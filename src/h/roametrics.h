@@ -0,0 +1,204 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Timing and throughput of the installer phases
+ *
+ * \file    	roametrics.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAMETRICS_H
+#define ROAMETRICS_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+#include <QElapsedTimer>
+
+/**
+ * \brief Measurements of one phase
+ */
+struct ROAPhaseMetrics
+{
+    /**
+     * \brief Time spent in the phase in nanoseconds
+     */
+    qint64 duration;
+
+    /**
+     * \brief Start of the running phase in nanoseconds, -1 if not running
+     */
+    qint64 started;
+
+    /**
+     * \brief Bytes handled in the phase
+     */
+    qint64 bytes;
+
+    /**
+     * \brief Files handled in the phase
+     */
+    int files;
+};
+
+/**
+ * \brief Collects wall time, bytes and files of the installer phases
+ *
+ * The phases are manifest, verify, download, write and postinstall.
+ * Verify and download overlap, they are measured from begin() to end().
+ * Write is the time spent writing and hashing the received data, it is added up with addTime().
+ */
+class ROAMetrics
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         */
+        ROAMetrics();
+
+        /**
+         * \brief Forget all measurements and start a new run
+         */
+        void reset();
+
+        /**
+         * \brief Start measuring the wall time of a phase
+         * \param _phase The phase
+         */
+        void begin(QString _phase);
+
+        /**
+         * \brief Stop measuring the wall time of a phase, does nothing if it is not running
+         * \param _phase The phase
+         */
+        void end(QString _phase);
+
+        /**
+         * \brief Stop all running phases
+         */
+        void endAll();
+
+        /**
+         * \brief Add time measured outside
+         * \param _phase The phase
+         * \param _nsecs The time in nanoseconds
+         */
+        void addTime(QString _phase, qint64 _nsecs);
+
+        /**
+         * \brief Count handled bytes
+         * \param _phase The phase
+         * \param _bytes Amount of bytes
+         */
+        void addBytes(QString _phase, qint64 _bytes);
+
+        /**
+         * \brief Count handled files
+         * \param _phase The phase
+         * \param _files Amount of files
+         */
+        void addFiles(QString _phase, int _files);
+
+        /**
+         * \brief Set a value of the whole run, e.g. the amount of requests
+         * \param _name The name, lower case with underscores
+         * \param _value The value
+         */
+        void setValue(QString _name, double _value);
+
+        /**
+         * \brief Get the throughput of a phase
+         * \param _phase The phase
+         * \return Bytes per second, 0 if nothing was measured
+         */
+        double getThroughput(QString _phase) const;
+
+        /**
+         * \brief Get a readable summary
+         * \return A line per phase and a line with the values of the run
+         */
+        QStringList getSummary() const;
+
+        /**
+         * \brief Get all measurements as named values
+         * \return <phase>_seconds, <phase>_bytes, <phase>_files and <phase>_bytes_per_second of each phase and the values of the run
+         */
+        QMap<QString, double> getValues() const;
+
+        /**
+         * \brief Write the measurements for the textfile collector of the Prometheus node exporter
+         * \param _fileName The file, should end with .prom
+         * \return True on success
+         */
+        bool writePrometheus(QString _fileName) const;
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The phases in the order they are reported
+         */
+        QStringList phases;
+
+        /**
+         * \brief The measurements of the phases
+         */
+        QHash<QString, ROAPhaseMetrics> values;
+
+        /**
+         * \brief Values of the whole run
+         */
+        QMap<QString, double> runValues;
+
+        /**
+         * \brief Timer since the reset
+         */
+        QElapsedTimer timer;
+};
+
+#endif // ROAMETRICS_H
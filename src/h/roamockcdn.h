@@ -0,0 +1,376 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Local test server for the engine
+ *
+ * \file    	roamockcdn.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAMOCKCDN_H
+#define ROAMOCKCDN_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * \brief A file served by the test server, the content is generated from the seed
+ */
+struct ROAMockFile
+{
+    /**
+     * \brief The file, relative to the platform directory
+     */
+    QString name;
+
+    /**
+     * \brief Size in bytes
+     */
+    qint64 size;
+
+    /**
+     * \brief Seed of the content
+     */
+    quint64 seed;
+
+    /**
+     * \brief SHA-256 of the content as hex string
+     */
+    QString hash;
+};
+
+/**
+ * \brief State of a client connection
+ */
+struct ROAMockConnection
+{
+    /**
+     * \brief Received data not handled yet
+     */
+    QByteArray input;
+
+    /**
+     * \brief Headers and small bodies waiting to be sent
+     */
+    QByteArray output;
+
+    /**
+     * \brief Index of the file of the running response, -1 if the body is in output
+     */
+    int file;
+
+    /**
+     * \brief Next byte of the file to send
+     */
+    qint64 position;
+
+    /**
+     * \brief End of the requested range, exclusive
+     */
+    qint64 end;
+
+    /**
+     * \brief Time in ms when the response may start
+     */
+    qint64 readyAt;
+
+    /**
+     * \brief Position at which the connection is dropped, -1 to send everything
+     */
+    qint64 dropAt;
+
+    /**
+     * \brief True while a response is sent
+     */
+    bool busy;
+
+    /**
+     * \brief Close the connection after the response
+     */
+    bool close;
+};
+
+/**
+ * \brief HTTP/1.1 server with a synthetic release for testing the engine without network
+ *
+ * Serves a file list for every platform and the files in it, with ranges and ETags for resuming.
+ * Latency, a bandwidth limit, dropped connections and error responses can be injected.
+ * All random decisions come from the seed and the request, runs with the same settings are reproducible
+ * no matter in which order the requests arrive.
+ */
+class ROAMockCdn : public QObject
+{
+        Q_OBJECT
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         * \param parent The parent
+         */
+        explicit ROAMockCdn(QObject *parent = 0);
+
+        /**
+         * \brief Create the release, the content is hashed once for the file list
+         * \param _files Amount of files
+         * \param _size Size of each file in bytes
+         */
+        void generate(int _files, qint64 _size);
+
+        /**
+         * \brief Delay each response
+         * \param _latency The delay in ms
+         */
+        void setLatency(int _latency);
+
+        /**
+         * \brief Limit the bandwidth of all connections together
+         * \param _bandwidth Bytes per second, 0 for no limit
+         */
+        void setBandwidth(qint64 _bandwidth);
+
+        /**
+         * \brief Drop connections in the middle of the body
+         * \param _rate Probability for each file response, 0 to 1
+         */
+        void setDropRate(double _rate);
+
+        /**
+         * \brief Answer with server errors
+         * \param _rate Probability for each request, 0 to 1
+         */
+        void setErrorRate(double _rate);
+
+        /**
+         * \brief Set the seed of the random decisions
+         * \param _seed The seed
+         */
+        void setSeed(quint64 _seed);
+
+        /**
+         * \brief Start listening on the loopback interface
+         * \param _port The port, 0 for any free port
+         * \return True on success
+         */
+        bool listen(quint16 _port);
+
+        /**
+         * \brief Get the port the server listens on
+         * \return The port
+         */
+        quint16 getPort() const;
+
+        /**
+         * \brief Fill a buffer with the content of a file
+         * \param _file The file
+         * \param _offset Position in the file
+         * \param _data The buffer
+         * \param _size Amount of bytes
+         */
+        static void fillData(const ROAMockFile &_file, qint64 _offset, char *_data, qint64 _size);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief The listening socket
+         */
+        QTcpServer server;
+
+        /**
+         * \brief Sends the responses in small steps, needed for latency and bandwidth
+         */
+        QTimer pumpTimer;
+
+        /**
+         * \brief Time since the server was created
+         */
+        QElapsedTimer clock;
+
+        /**
+         * \brief The files of the release
+         */
+        QList<ROAMockFile> files;
+
+        /**
+         * \brief Index of the files by name
+         */
+        QHash<QString, int> fileIndex;
+
+        /**
+         * \brief The file list
+         */
+        QByteArray manifest;
+
+        /**
+         * \brief The client connections
+         */
+        QHash<QTcpSocket*, ROAMockConnection> connections;
+
+        /**
+         * \brief Delay of each response in ms
+         */
+        int latency;
+
+        /**
+         * \brief Bytes per second of all connections, 0 for no limit
+         */
+        qint64 bandwidth;
+
+        /**
+         * \brief Bytes which may be sent until the next step
+         */
+        qint64 budget;
+
+        /**
+         * \brief Parts of a byte from the last steps, in bytes per 1000
+         */
+        qint64 budgetFraction;
+
+        /**
+         * \brief Count of the steps, decides which response is served first
+         */
+        int pumpRound;
+
+        /**
+         * \brief Time of the last step in ms
+         */
+        qint64 lastPump;
+
+        /**
+         * \brief Probability of dropping a file response
+         */
+        double dropRate;
+
+        /**
+         * \brief Probability of an error response
+         */
+        double errorRate;
+
+        /**
+         * \brief Seed of the random decisions
+         */
+        quint64 seed;
+
+        /**
+         * \brief Count of each request by path and range, retries get other decisions
+         */
+        QHash<QString, int> attempts;
+
+        /**
+         * \brief Buffer for the generated content
+         */
+        QByteArray buffer;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Get a random number for a request, independent of the order of the requests
+         * \param _path The path of the request
+         * \param _start Start of the range
+         * \param _attempt How often the request came before
+         * \param _kind Kind of the decision
+         * \return A number from 0 to 1
+         */
+        double decide(QString _path, qint64 _start, int _attempt, quint64 _kind);
+
+        /**
+         * \brief Parse the complete requests of a connection and answer the first one
+         * \param _socket The connection
+         */
+        void handleRequests(QTcpSocket *_socket);
+
+        /**
+         * \brief Prepare the response of a request
+         * \param _connection The connection
+         * \param _method GET or HEAD
+         * \param _path The path of the request
+         * \param _headers The headers with lower case names
+         */
+        void respond(ROAMockConnection &_connection, QString _method, QString _path, const QHash<QByteArray, QByteArray> &_headers);
+
+        /**
+         * \brief Send the next part of the response
+         * \param _socket The connection
+         * \param _limit Maximal amount of bytes, -1 for no limit
+         * \return Amount of bytes sent
+         */
+        qint64 send(QTcpSocket *_socket, qint64 _limit);
+
+    private slots:
+
+        /**
+         * \brief Accepts new connections
+         */
+        void slot_newConnection();
+
+        /**
+         * \brief Reads the requests of a connection
+         */
+        void slot_readyRead();
+
+        /**
+         * \brief Forgets closed connections
+         */
+        void slot_disconnected();
+
+        /**
+         * \brief Sends the next step of all responses
+         */
+        void slot_pump();
+};
+
+#endif // ROAMOCKCDN_H
@@ -0,0 +1,209 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Byte based progress of the downloads with throughput and remaining time
+ *
+ * \file    	roaprogress.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROAPROGRESS_H
+#define ROAPROGRESS_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+
+/**
+ * \brief Tracks the progress of the downloads in bytes
+ *
+ * The total is the size of the queued files from the file list.
+ * Received data counts for its file up to the file size, finished files count with their full size.
+ * Throughput and the rate of the progress are smoothed over the last seconds.
+ */
+class ROAProgress
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor
+         */
+        ROAProgress();
+
+        /**
+         * \brief Forget all files and start measuring again
+         */
+        void reset();
+
+        /**
+         * \brief Add a file to download
+         * \param _file The file, relative to the installation path
+         * \param _size The size of the file, -1 if unknown
+         */
+        void addFile(QString _file, qint64 _size);
+
+        /**
+         * \brief Set the size of a file with an unknown size, e.g. from the Content-Length
+         * \param _file The file, relative to the installation path
+         * \param _size The size of the file
+         */
+        void setFileSize(QString _file, qint64 _size);
+
+        /**
+         * \brief Count received data
+         * \param _file The file the data belongs to, unknown files only count for the throughput
+         * \param _bytes Amount of received bytes
+         */
+        void addReceived(QString _file, qint64 _bytes);
+
+        /**
+         * \brief Get the received data of a running file
+         * \param _file The file, relative to the installation path
+         * \return The received bytes, 0 for unknown files
+         */
+        qint64 getReceived(QString _file) const;
+
+        /**
+         * \brief Mark a file as done, installed or failed
+         * \param _file The file, relative to the installation path
+         */
+        void finishFile(QString _file);
+
+        /**
+         * \brief Update the smoothed rates, call it in regular intervals
+         */
+        void sample();
+
+        /**
+         * \brief Get the progress
+         * \return The progress in percent
+         */
+        int getPercent() const;
+
+        /**
+         * \brief Get the bytes done
+         * \return The finished files and the received part of the running ones
+         */
+        qint64 getDone() const;
+
+        /**
+         * \brief Get the bytes to download
+         * \return The size of all added files
+         */
+        qint64 getTotal() const;
+
+        /**
+         * \brief Get the smoothed download speed
+         * \return The received bytes per second
+         */
+        double getThroughput() const;
+
+        /**
+         * \brief Get the estimated remaining time
+         * \return The remaining seconds, -1 if unknown
+         */
+        qint64 getRemainingTime() const;
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Sizes of the files not finished yet
+         */
+        QHash<QString, qint64> sizes;
+
+        /**
+         * \brief Received bytes of the files not finished yet
+         */
+        QHash<QString, qint64> received;
+
+        /**
+         * \brief Size of all added files
+         */
+        qint64 total;
+
+        /**
+         * \brief Size of the finished files
+         */
+        qint64 finished;
+
+        /**
+         * \brief All received bytes
+         */
+        qint64 receivedTotal;
+
+        /**
+         * \brief Timer since the reset
+         */
+        QElapsedTimer timer;
+
+        /**
+         * \brief Time of the last sample in nanoseconds
+         */
+        qint64 lastSample;
+
+        /**
+         * \brief Received bytes at the last sample
+         */
+        qint64 lastReceived;
+
+        /**
+         * \brief Done bytes at the last sample
+         */
+        qint64 lastDone;
+
+        /**
+         * \brief Smoothed received bytes per second
+         */
+        double throughput;
+
+        /**
+         * \brief Smoothed done bytes per second
+         */
+        double rate;
+};
+
+#endif // ROAPROGRESS_H
@@ -0,0 +1,227 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Streaming extraction of tar bundles
+ *
+ * \file    	roatarextractor.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROATAREXTRACTOR_H
+#define ROATAREXTRACTOR_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+#include <QFile>
+#include <QCryptographicHash>
+
+/**
+ * \brief Extracts a tar stream while it is written to the device
+ *
+ * Only regular files listed with their hash are extracted, everything else is skipped.
+ * Each member is written to <file>.part and hashed on the fly, members with a wrong hash are removed.
+ *
+ * Members must be named with their full path relative to the installation path, e.g. game/data/textures.pak.
+ * Longer names use the ustar prefix. Pax and GNU long name headers are rejected, their names would not match
+ * the file list and a pax header could change the name of the following member.
+ */
+class ROATarExtractor : public QIODevice
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor, the device is opened for writing
+         * \param _installationPath The installation path the members are relative to
+         * \param _members The expected SHA-256 of the members to extract mapped to their name
+         */
+        ROATarExtractor(QString _installationPath, const QHash<QString, QString> &_members);
+
+        /**
+         * \brief Deconstructor, removes an incomplete member
+         */
+        ~ROATarExtractor();
+
+        /**
+         * \brief Get the members extracted to their .part file with a matching hash
+         * \return The names of the members
+         */
+        QStringList getExtractedFiles() const;
+
+        /**
+         * \brief Check if the end of the archive was reached
+         * \return True if the archive is complete
+         */
+        bool isFinished() const;
+
+        /**
+         * \brief Get the bytes written to each member since the last call
+         * \return The written bytes mapped to the member names
+         */
+        QHash<QString, qint64> takeWrittenBytes();
+
+    protected:
+
+        /**
+         * \brief Reading is not supported
+         */
+        qint64 readData(char *_data, qint64 _size);
+
+        /**
+         * \brief Parse the next part of the tar stream
+         */
+        qint64 writeData(const char *_data, qint64 _size);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Part of the stream currently parsed
+         */
+        enum State
+        {
+            Header,
+            Data,
+            Padding,
+            End
+        };
+
+        /**
+         * \brief The installation path
+         */
+        QString installationPath;
+
+        /**
+         * \brief The expected hashes mapped to the member names
+         */
+        QHash<QString, QString> members;
+
+        /**
+         * \brief Verified members
+         */
+        QStringList extracted;
+
+        /**
+         * \brief Part of the stream currently parsed
+         */
+        State state;
+
+        /**
+         * \brief The header block collected so far
+         */
+        QByteArray block;
+
+        /**
+         * \brief Bytes of member data left
+         */
+        qint64 remaining;
+
+        /**
+         * \brief Bytes of padding left after the member data
+         */
+        qint64 padding;
+
+        /**
+         * \brief Name of the current member
+         */
+        QString name;
+
+        /**
+         * \brief Bytes written to the members since the last call of takeWrittenBytes
+         */
+        QHash<QString, qint64> written;
+
+        /**
+         * \brief The file the current member is extracted to, 0 if it is skipped
+         */
+        QFile *file;
+
+        /**
+         * \brief Hash of the current member
+         */
+        QCryptographicHash *hash;
+
+        /**
+         * \brief True if the stream is not a valid tar archive
+         */
+        bool failed;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Parse a complete header block and start the member
+         */
+        void parseHeader();
+
+        /**
+         * \brief Verify the extracted member once all data was written
+         */
+        void finishMember();
+
+        /**
+         * \brief Parse an octal number field of the header
+         * \param _offset Offset of the field in the block
+         * \param _size Size of the field
+         * \return The number, -1 if the field is invalid
+         */
+        qint64 readOctal(int _offset, int _size) const;
+
+        /**
+         * \brief Read a zero terminated string field of the header
+         * \param _offset Offset of the field in the block
+         * \param _size Size of the field
+         * \return The content of the field
+         */
+        QByteArray readString(int _offset, int _size) const;
+};
+
+#endif // ROATAREXTRACTOR_H
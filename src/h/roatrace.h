@@ -0,0 +1,174 @@
+/**
+ * \copyright   Copyright © 2012 QuantumBytes inc.
+ *
+ *              For more information, see https://www.quantum-bytes.com/
+ *
+ * \section LICENSE
+ *
+ *              This file is part of Relics of Annorath Installer.
+ *
+ *              Relics of Annorath Installer is free software: you can redistribute it and/or modify
+ *              it under the terms of the GNU General Public License as published by
+ *              the Free Software Foundation, either version 3 of the License, or
+ *              any later version.
+ *
+ *              Relics of Annorath Installer is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with Relics of Annorath Installer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \brief       Chrome trace of the install pipeline
+ *
+ * \file    	roatrace.h
+ *
+ * \note
+ *
+ * \version 	1.0
+ *
+ * \author  	Manuel Gysin <manuel.gysin@quantum-bytes.com>
+ *
+ * \date        2012/12/01 23:10:00 GMT+1
+ *
+ */
+
+#ifndef ROATRACE_H
+#define ROATRACE_H
+
+/******************************************************************************/
+/*                                                                            */
+/*    Qt includes                                                             */
+/*                                                                            */
+/******************************************************************************/
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QThread>
+
+/**
+ * \brief Writes spans in the trace event format of Chrome (about:tracing) and Perfetto
+ *
+ * The events are streamed as a JSON array, a run which was killed can still be loaded.
+ * All methods are thread safe, each thread gets its own track.
+ */
+class ROATrace
+{
+    public:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Constructor, opens the file
+         * \param _fileName The trace file
+         */
+        ROATrace(QString _fileName);
+
+        /**
+         * \brief Deconstuctor, closes the file
+         */
+        ~ROATrace();
+
+        /**
+         * \brief Check if the file could be opened
+         * \return True if events are written
+         */
+        bool isOpen() const;
+
+        /**
+         * \brief Get the time for the start of a span
+         * \return Microseconds since the trace was opened
+         */
+        qint64 now() const;
+
+        /**
+         * \brief Write a span of the current thread which ends now
+         * \param _name The name of the span
+         * \param _start The start from now()
+         * \param _file The file the span belongs to
+         */
+        void complete(QString _name, qint64 _start, QString _file);
+
+        /**
+         * \brief Write a point in time of the current thread
+         * \param _name The name of the event
+         * \param _file The file or URL the event belongs to
+         */
+        void instant(QString _name, QString _file);
+
+        /**
+         * \brief Begin a span which may overlap others, e.g. a request
+         * \param _name The name of the span
+         * \param _id Identifies the span, spans with the same id are nested
+         * \param _file The file or URL the span belongs to
+         */
+        void asyncBegin(QString _name, const void *_id, QString _file);
+
+        /**
+         * \brief End a span started with asyncBegin()
+         * \param _name The name of the span
+         * \param _id Identifies the span
+         */
+        void asyncEnd(QString _name, const void *_id);
+
+    private:
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Members                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Serializes the writes of all threads
+         */
+        QMutex mutex;
+
+        /**
+         * \brief The trace file
+         */
+        QFile file;
+
+        /**
+         * \brief Time since the trace was opened
+         */
+        QElapsedTimer timer;
+
+        /**
+         * \brief Small ids of the threads seen so far
+         */
+        QHash<Qt::HANDLE, int> threads;
+
+        /**
+         * \brief True until the first event is written
+         */
+        bool first;
+
+        /******************************************************************************/
+        /*                                                                            */
+        /*    Methods                                                                 */
+        /*                                                                            */
+        /******************************************************************************/
+
+        /**
+         * \brief Write an event, the mutex has to be locked
+         * \param _event The event, pid and tid are added
+         */
+        void write(QJsonObject _event);
+
+        /**
+         * \brief Get the id of the current thread, the thread name is written on first use
+         * \return The id of the thread in the trace
+         */
+        int threadId();
+};
+
+#endif // ROATRACE_H